@@ -119,8 +119,17 @@ typedef struct
     
     /* List of reference elements: */
     pmh_realelement *references;
+    
+    /* Polled while parsing to abort it (may be NULL): */
+    pmh_cancel_callback is_cancelled;
+    void *cancel_context;
+    int chars_until_poll;
+    bool cancelled;
 } parser_data;
 
+/* Number of characters read between two polls of is_cancelled: */
+#define pmh_CANCEL_POLL_INTERVAL 4096
+
 static parser_data *mk_parser_data(char *original_input,
                                    unsigned long *strip_positions,
                                    size_t strip_positions_len,
@@ -141,6 +150,10 @@ static parser_data *mk_parser_data(char *original_input,
     p_data->elem_head = p_data->current_elem = parsing_elems;
     p_data->references = references;
     p_data->parsing_only_references = false;
+    p_data->is_cancelled = NULL;
+    p_data->cancel_context = NULL;
+    p_data->chars_until_poll = pmh_CANCEL_POLL_INTERVAL;
+    p_data->cancelled = false;
     if (head_elems != NULL)
         p_data->head_elems = head_elems;
     else {
@@ -162,40 +175,43 @@ static void parse_references(parser_data *p_data);
 
 
 
+static char **make_element_type_names()
+{
+    char **elem_type_names = (char **)malloc(sizeof(char*) * pmh_NUM_LANG_TYPES);
+    int i;
+    for (i = 0; i < pmh_NUM_LANG_TYPES; i++)
+        elem_type_names[i] = NULL;
+    elem_type_names[pmh_LINK] = "LINK";
+    elem_type_names[pmh_AUTO_LINK_URL] = "AUTO_LINK_URL";
+    elem_type_names[pmh_AUTO_LINK_EMAIL] = "AUTO_LINK_EMAIL";
+    elem_type_names[pmh_IMAGE] = "IMAGE";
+    elem_type_names[pmh_CODE] = "CODE";
+    elem_type_names[pmh_HTML] = "HTML";
+    elem_type_names[pmh_HTML_ENTITY] = "HTML_ENTITY";
+    elem_type_names[pmh_EMPH] = "EMPH";
+    elem_type_names[pmh_STRONG] = "STRONG";
+    elem_type_names[pmh_LIST_BULLET] = "LIST_BULLET";
+    elem_type_names[pmh_LIST_ENUMERATOR] = "LIST_ENUMERATOR";
+    elem_type_names[pmh_COMMENT] = "COMMENT";
+    elem_type_names[pmh_H1] = "H1";
+    elem_type_names[pmh_H2] = "H2";
+    elem_type_names[pmh_H3] = "H3";
+    elem_type_names[pmh_H4] = "H4";
+    elem_type_names[pmh_H5] = "H5";
+    elem_type_names[pmh_H6] = "H6";
+    elem_type_names[pmh_BLOCKQUOTE] = "BLOCKQUOTE";
+    elem_type_names[pmh_VERBATIM] = "VERBATIM";
+    elem_type_names[pmh_HTMLBLOCK] = "HTMLBLOCK";
+    elem_type_names[pmh_HRULE] = "HRULE";
+    elem_type_names[pmh_REFERENCE] = "REFERENCE";
+    elem_type_names[pmh_NOTE] = "NOTE";
+    return elem_type_names;
+}
+
 static char **get_element_type_names()
 {
-    static char **elem_type_names = NULL;
-    if (elem_type_names == NULL)
-    {
-        elem_type_names = (char **)malloc(sizeof(char*) * pmh_NUM_LANG_TYPES);
-        int i;
-        for (i = 0; i < pmh_NUM_LANG_TYPES; i++)
-            elem_type_names[i] = NULL;
-        elem_type_names[pmh_LINK] = "LINK";
-        elem_type_names[pmh_AUTO_LINK_URL] = "AUTO_LINK_URL";
-        elem_type_names[pmh_AUTO_LINK_EMAIL] = "AUTO_LINK_EMAIL";
-        elem_type_names[pmh_IMAGE] = "IMAGE";
-        elem_type_names[pmh_CODE] = "CODE";
-        elem_type_names[pmh_HTML] = "HTML";
-        elem_type_names[pmh_HTML_ENTITY] = "HTML_ENTITY";
-        elem_type_names[pmh_EMPH] = "EMPH";
-        elem_type_names[pmh_STRONG] = "STRONG";
-        elem_type_names[pmh_LIST_BULLET] = "LIST_BULLET";
-        elem_type_names[pmh_LIST_ENUMERATOR] = "LIST_ENUMERATOR";
-        elem_type_names[pmh_COMMENT] = "COMMENT";
-        elem_type_names[pmh_H1] = "H1";
-        elem_type_names[pmh_H2] = "H2";
-        elem_type_names[pmh_H3] = "H3";
-        elem_type_names[pmh_H4] = "H4";
-        elem_type_names[pmh_H5] = "H5";
-        elem_type_names[pmh_H6] = "H6";
-        elem_type_names[pmh_BLOCKQUOTE] = "BLOCKQUOTE";
-        elem_type_names[pmh_VERBATIM] = "VERBATIM";
-        elem_type_names[pmh_HTMLBLOCK] = "HTMLBLOCK";
-        elem_type_names[pmh_HRULE] = "HRULE";
-        elem_type_names[pmh_REFERENCE] = "REFERENCE";
-        elem_type_names[pmh_NOTE] = "NOTE";
-    }
+    // Initialized only once, even if called from several threads
+    static char **elem_type_names = make_element_type_names();
     return elem_type_names;
 }
 
@@ -306,12 +322,12 @@ iteratively until no such elements exist.
 static void process_raw_blocks(parser_data *p_data)
 {
     pmh_PRINTF("--------process_raw_blocks---------\n");
-    while (p_data->head_elems[pmh_RAW_LIST] != NULL)
+    while (p_data->head_elems[pmh_RAW_LIST] != NULL && !p_data->cancelled)
     {
         pmh_PRINTF("new iteration.\n");
         pmh_realelement *cursor = p_data->head_elems[pmh_RAW_LIST];
         p_data->head_elems[pmh_RAW_LIST] = NULL;
-        while (cursor != NULL)
+        while (cursor != NULL && !p_data->cancelled)
         {
             pmh_realelement *span_list = (pmh_realelement*)cursor->children;
             
@@ -323,7 +339,7 @@ static void process_raw_blocks(parser_data *p_data)
             pmh_PRINTF("\n");
             #endif
             
-            while (span_list != NULL)
+            while (span_list != NULL && !p_data->cancelled)
             {
                 pmh_PRINTF("next: span_list: %ld-%ld\n",
                            span_list->pos, span_list->end);
@@ -365,7 +381,14 @@ static void process_raw_blocks(parser_data *p_data)
                     p_data->head_elems,
                     p_data->references
                 );
+                // Raw spans are usually shorter than the poll interval,
+                // so the countdown continues across all of them:
+                raw_p_data->is_cancelled = p_data->is_cancelled;
+                raw_p_data->cancel_context = p_data->cancel_context;
+                raw_p_data->chars_until_poll = p_data->chars_until_poll;
                 parse_markdown(raw_p_data);
+                p_data->chars_until_poll = raw_p_data->chars_until_poll;
+                p_data->cancelled = raw_p_data->cancelled;
                 free(raw_p_data);
                 
                 pmh_PRINTF("parse over\n");
@@ -493,6 +516,24 @@ static int strcpy_preformat(char *str, char **out,
 
 void pmh_markdown_to_elements(char *text, int extensions,
                               pmh_element **out_result[])
+{
+    pmh_markdown_to_elements_cancellable(text, extensions, out_result,
+                                         NULL, NULL);
+}
+
+bool pmh_markdown_to_elements_cancellable(char *text, int extensions,
+                                          pmh_element **out_result[],
+                                          pmh_cancel_callback is_cancelled,
+                                          void *context)
+{
+    return pmh_markdown_to_elements_with_references(text, extensions, NULL,
+                                                    out_result,
+                                                    is_cancelled, context);
+}
+
+pmh_element **pmh_markdown_to_references(char *text, int extensions,
+                                         pmh_cancel_callback is_cancelled,
+                                         void *context)
 {
     char *text_copy = NULL;
     unsigned long *strip_positions = NULL;
@@ -518,19 +559,122 @@ void pmh_markdown_to_elements(char *text, int extensions,
         NULL,
         NULL
     );
+    p_data->is_cancelled = is_cancelled;
+    p_data->cancel_context = context;
     pmh_realelement **result = p_data->head_elems;
     
     if (*text_copy != '\0')
-    {
-        // Get reference definitions into p_data->references
         parse_references(p_data);
+    
+    // The definitions stay in the result to be freed with it
+    result[pmh_REFERENCE] = p_data->references;
+    
+    bool cancelled = p_data->cancelled;
+    
+    free(strip_positions);
+    free(p_data);
+    free(parsing_elem);
+    free(text_copy);
+    
+    // The definitions of an aborted parse are incomplete
+    if (cancelled)
+    {
+        pmh_free_elements((pmh_element**)result);
+        result = NULL;
+    }
+    
+    return (pmh_element**)result;
+}
+
+void pmh_merge_elements(pmh_element **target, pmh_element **source,
+                        unsigned long offset, unsigned long length)
+{
+    int i;
+    for (i = 0; i < pmh_NUM_LANG_TYPES; i++)
+    {
+        pmh_element *cursor = source[i];
+        if (cursor == NULL)
+            continue;
         
-        // Reset parser state to beginning of input
-        p_data->offset = 0;
-        p_data->current_elem = p_data->elem_head;
+        pmh_element *tail = NULL;
+        while (cursor != NULL)
+        {
+            cursor->pos = offset + (cursor->pos < length ? cursor->pos : length);
+            cursor->end = offset + (cursor->end < length ? cursor->end : length);
+            tail = cursor;
+            cursor = cursor->next;
+        }
         
-        // Parse whole document
-        parse_markdown(p_data);
+        tail->next = target[i];
+        target[i] = source[i];
+    }
+    
+    // Hand over the ownership of all elements
+    pmh_realelement *all = (pmh_realelement *)source[pmh_ALL];
+    if (all != NULL)
+    {
+        pmh_realelement *all_tail = all;
+        while (all_tail->all_elems_next != NULL)
+            all_tail = all_tail->all_elems_next;
+        all_tail->all_elems_next = (pmh_realelement *)target[pmh_ALL];
+        target[pmh_ALL] = (pmh_element *)all;
+    }
+    
+    free(source);
+}
+
+bool pmh_markdown_to_elements_with_references(char *text, int extensions,
+                                              pmh_element **references,
+                                              pmh_element **out_result[],
+                                              pmh_cancel_callback is_cancelled,
+                                              void *context)
+{
+    char *text_copy = NULL;
+    unsigned long *strip_positions = NULL;
+    size_t strip_positions_len = 0;
+    int text_copy_len = strcpy_preformat(text, &text_copy, &strip_positions,
+                                         &strip_positions_len);
+    
+    pmh_realelement *parsing_elem = (pmh_realelement *)
+                                    malloc(sizeof(pmh_realelement));
+    parsing_elem->type = pmh_RAW;
+    parsing_elem->pos = 0;
+    parsing_elem->end = text_copy_len;
+    parsing_elem->next = NULL;
+    
+    parser_data *p_data = mk_parser_data(
+        text,
+        strip_positions,
+        strip_positions_len,
+        text_copy,
+        parsing_elem,
+        0,
+        extensions,
+        NULL,
+        NULL
+    );
+    p_data->is_cancelled = is_cancelled;
+    p_data->cancel_context = context;
+    pmh_realelement **result = p_data->head_elems;
+    
+    if (*text_copy != '\0')
+    {
+        // Get reference definitions into p_data->references
+        // (unless they were parsed from the whole document before)
+        if (references != NULL)
+            p_data->references = (pmh_realelement *)references[pmh_REFERENCE];
+        else
+            parse_references(p_data);
+        
+        if (!p_data->cancelled)
+        {
+            // Reset parser state to beginning of input
+            p_data->offset = 0;
+            p_data->current_elem = p_data->elem_head;
+            
+            // Parse whole document
+            parse_markdown(p_data);
+        }
         
         #if pmh_DEBUG_OUTPUT
         print_raw_blocks(text_copy, result);
@@ -539,12 +683,22 @@ void pmh_markdown_to_elements(char *text, int extensions,
         process_raw_blocks(p_data);
     }
     
+    bool cancelled = p_data->cancelled;
+    
     free(strip_positions);
     free(p_data);
     free(parsing_elem);
     free(text_copy);
     
+    // The elements of an aborted parse are incomplete
+    if (cancelled)
+    {
+        pmh_free_elements((pmh_element**)result);
+        result = NULL;
+    }
+    
     *out_result = (pmh_element**)result;
+    return !cancelled;
 }
 
 
@@ -953,6 +1107,19 @@ static char *copy_input_span(parser_data *p_data,
 static void yy_input_func(char *buf, int *result, int max_size,
                           parser_data *p_data)
 {
+    // Pretend the input ended once the parsing was cancelled
+    if (p_data->is_cancelled != NULL && --p_data->chars_until_poll <= 0)
+    {
+        p_data->chars_until_poll = pmh_CANCEL_POLL_INTERVAL;
+        p_data->cancelled = p_data->cancelled
+                            || p_data->is_cancelled(p_data->cancel_context);
+    }
+    if (p_data->cancelled)
+    {
+        (*result) = 0;
+        return;
+    }
+    
     if (p_data->current_elem == NULL)
     {
         (*result) = 0;
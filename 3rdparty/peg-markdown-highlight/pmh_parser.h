@@ -39,6 +39,108 @@
 void pmh_markdown_to_elements(char *text, int extensions,
                               pmh_element **out_result[]);
 
+/**
+* \brief Cancellation callback
+* 
+* Polled regularly while parsing. Returns non-zero if the parsing
+* should be aborted.
+* 
+* \param[in]  context  The context given to
+*                      pmh_markdown_to_elements_cancellable().
+*/
+typedef int (*pmh_cancel_callback)(void *context);
+
+/**
+* \brief Parse Markdown text, return elements, unless cancelled
+* 
+* Like pmh_markdown_to_elements(), but polls `is_cancelled` while
+* parsing and stops as soon as it returns non-zero.
+* 
+* \param[in]  text          The Markdown text to parse for highlighting.
+* \param[in]  extensions    The extensions to use in parsing (a bitfield
+*                           of pmh_extensions values).
+* \param[out] out_result    The results of the parsing (see
+*                           pmh_markdown_to_elements()), or NULL if
+*                           the parsing was cancelled.
+* \param[in]  is_cancelled  The cancellation callback (may be NULL).
+* \param[in]  context       Passed to `is_cancelled`.
+* \return     false if the parsing was cancelled.
+* 
+* \sa pmh_markdown_to_elements
+*/
+bool pmh_markdown_to_elements_cancellable(char *text, int extensions,
+                                          pmh_element **out_result[],
+                                          pmh_cancel_callback is_cancelled,
+                                          void *context);
+
+/**
+* \brief Parse only the reference definitions of Markdown text
+* 
+* Used to parse a document in independent parts: the reference
+* definitions of the whole document are passed to
+* pmh_markdown_to_elements_with_references() for each part. The
+* definitions of several parts can be combined with
+* pmh_merge_elements().
+* 
+* \param[in]  text          The Markdown text (the whole document or
+*                           a part of it).
+* \param[in]  extensions    The extensions to use in parsing (a bitfield
+*                           of pmh_extensions values).
+* \param[in]  is_cancelled  The cancellation callback (may be NULL).
+* \param[in]  context       Passed to `is_cancelled`.
+* \return     A pmh_element array, where the pmh_REFERENCE list contains
+*             the reference definitions, or NULL if the parsing was
+*             cancelled. You must pass this to pmh_free_elements() when
+*             it's not needed anymore.
+* 
+* \sa pmh_markdown_to_elements_with_references
+*/
+pmh_element **pmh_markdown_to_references(char *text, int extensions,
+                                         pmh_cancel_callback is_cancelled,
+                                         void *context);
+
+/**
+* \brief Parse a part of Markdown text, return elements, unless cancelled
+* 
+* Like pmh_markdown_to_elements_cancellable(), but resolves reference
+* links with the given reference definitions instead of parsing them
+* from `text`. Several parts can be parsed concurrently with the same
+* reference definitions.
+* 
+* \param[in]  text          The Markdown text to parse for highlighting.
+* \param[in]  extensions    The extensions to use in parsing (a bitfield
+*                           of pmh_extensions values).
+* \param[in]  references    The result of pmh_markdown_to_references().
+* \param[out] out_result    The results of the parsing, or NULL if
+*                           the parsing was cancelled.
+* \param[in]  is_cancelled  The cancellation callback (may be NULL).
+* \param[in]  context       Passed to `is_cancelled`.
+* \return     false if the parsing was cancelled.
+* 
+* \sa pmh_markdown_to_references
+* \sa pmh_merge_elements
+*/
+bool pmh_markdown_to_elements_with_references(char *text, int extensions,
+                                              pmh_element **references,
+                                              pmh_element **out_result[],
+                                              pmh_cancel_callback is_cancelled,
+                                              void *context);
+
+/**
+* \brief Move the elements of a parsed part into another result
+* 
+* Adds `offset` to the positions of the elements in `source`, limits
+* them to `offset + length` (the parser appends newlines to its input)
+* and moves them into `target`. The `source` array is freed.
+* 
+* \param[in]  target  The pmh_element array to move the elements to.
+* \param[in]  source  The pmh_element array of the parsed part.
+* \param[in]  offset  The offset of the part in the whole text.
+* \param[in]  length  The length of the part.
+*/
+void pmh_merge_elements(pmh_element **target, pmh_element **source,
+                        unsigned long offset, unsigned long length);
+
 /**
 * \brief Sort elements in list by start offset.
 * 
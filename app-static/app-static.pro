@@ -16,19 +16,31 @@ INCLUDEPATH += $$PWD
 SOURCES += \
     snippets/jsonsnippettranslator.cpp \
     snippets/snippetcollection.cpp \
+    converter/chunkedmarkdownconverter.cpp \
     converter/discountmarkdownconverter.cpp \
     spellchecker/dictionary.cpp \
     converter/revealmarkdownconverter.cpp \
+    template/highlightjssupport.cpp \
     template/htmltemplate.cpp \
+    template/mathjaxsupport.cpp \
+    template/mermaidsupport.cpp \
     template/presentationtemplate.cpp \
     themes/jsonthemetranslator.cpp \
     themes/stylemanager.cpp \
     themes/theme.cpp \
     themes/themecollection.cpp \
+    autosavejournal.cpp \
     completionlistmodel.cpp \
     datalocation.cpp \
+    documentfragmentcache.cpp \
+    fragmentcache.cpp \
+    latencytracer.cpp \
     slidelinemapping.cpp \
+    sourcelineannotator.cpp \
+    stallwatchdog.cpp \
+    tracerecorder.cpp \
     viewsynchronizer.cpp \
+    wordcounter.cpp \
     revealviewsynchronizer.cpp \
     htmlpreviewcontroller.cpp \
     htmlviewsynchronizer.cpp \
@@ -41,21 +53,34 @@ HEADERS += \
     snippets/snippetcollection.h \
     converter/markdownconverter.h \
     converter/markdowndocument.h \
+    converter/chunkedmarkdownconverter.h \
     converter/discountmarkdownconverter.h \
     spellchecker/dictionary.h \
     converter/revealmarkdownconverter.h \
     template/template.h \
+    template/highlightjssupport.h \
     template/htmltemplate.h \
+    template/mathjaxsupport.h \
+    template/mermaidsupport.h \
     template/presentationtemplate.h \
     themes/jsonthemetranslator.h \
     themes/jsonthemetranslatorfactory.h \
     themes/stylemanager.h \
     themes/theme.h \
     themes/themecollection.h \
+    autosavejournal.h \
     completionlistmodel.h \
     datalocation.h \
+    documentfragmentcache.h \
+    fragmentcache.h \
+    latencytracer.h \
+    latestvaluemailbox.h \
     slidelinemapping.h \
+    sourcelineannotator.h \
+    stallwatchdog.h \
+    tracerecorder.h \
     viewsynchronizer.h \
+    wordcounter.h \
     revealviewsynchronizer.h \
     htmlpreviewcontroller.h \
     htmlviewsynchronizer.h \
@@ -84,6 +109,11 @@ macx:INCLUDEPATH += /usr/local/include
 #
 INCLUDEPATH += $$PWD/../libs/jsonconfig
 
+#
+# Markdown chunking helpers (header only)
+#
+INCLUDEPATH += $$PWD/../libs/markdownchunks
+
 #
 # Discount library
 #
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "autosavejournal.h"
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTimer>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const quint32 JOURNAL_MAGIC = 0x434d4a31; // "CMJ1"
+static const quint8 SNAPSHOT_RECORD = 'S';
+static const quint8 CHANGE_RECORD = 'C';
+
+static const int FLUSH_INTERVAL = 1000;
+static const qint64 MINIMUM_COMPACTION_SIZE = 1024 * 1024;
+
+static void syncToDisk(QFile &file)
+{
+    file.flush();
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+
+AutosaveJournal::AutosaveJournal(const QString &fileName, QObject *parent) :
+    QObject(parent),
+    journalFileName(fileName),
+    file(fileName),
+    lock(fileName + QStringLiteral(".lock")),
+    flushTimer(new QTimer(this)),
+    snapshotPending(false),
+    snapshotSize(0),
+    changesSize(0)
+{
+    // a document is edited for hours without saving, so the lock must
+    // only become stale if the process holding it is gone
+    lock.setStaleLockTime(0);
+
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(FLUSH_INTERVAL);
+    connect(flushTimer, SIGNAL(timeout()), SLOT(flush()));
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+    flush();
+}
+
+QString AutosaveJournal::fileName() const
+{
+    return journalFileName;
+}
+
+bool AutosaveJournal::start(const QString &text)
+{
+    // another instance may journal the same document
+    if (!lock.tryLock(0)) {
+        return false;
+    }
+
+    // the snapshot is written with the first batch of changes,
+    // so an unmodified document costs nothing
+    snapshot = text;
+    snapshotPending = true;
+    pendingChanges.clear();
+
+    return true;
+}
+
+void AutosaveJournal::recordChange(int position, int charsRemoved, const QString &addedText)
+{
+    if (!lock.isLocked()) {
+        return;
+    }
+
+    QDataStream out(&pendingChanges, QIODevice::Append);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << CHANGE_RECORD << qint32(position) << qint32(charsRemoved) << addedText;
+
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+bool AutosaveJournal::needsCompaction() const
+{
+    // replaying the changes should never take longer than loading a snapshot
+    return changesSize + pendingChanges.size() > qMax(snapshotSize, MINIMUM_COMPACTION_SIZE);
+}
+
+void AutosaveJournal::compact(const QString &text)
+{
+    if (!lock.isLocked()) {
+        return;
+    }
+
+    // the new snapshot already contains all changes
+    snapshot = text;
+    snapshotPending = true;
+    pendingChanges.clear();
+
+    flush();
+}
+
+void AutosaveJournal::discard()
+{
+    flushTimer->stop();
+
+    file.close();
+    QFile::remove(journalFileName);
+    lock.unlock();
+
+    snapshot.clear();
+    snapshotPending = false;
+    pendingChanges.clear();
+    snapshotSize = 0;
+    changesSize = 0;
+}
+
+bool AutosaveJournal::isOrphaned(const QString &fileName)
+{
+    if (!QFile::exists(fileName)) {
+        return false;
+    }
+
+    // the lock of a crashed instance is stale and can be taken over,
+    // which is decided by the process id and host name of the lock only
+    QLockFile lock(fileName + QStringLiteral(".lock"));
+    lock.setStaleLockTime(0);
+    return lock.tryLock(0);
+}
+
+bool AutosaveJournal::recover(const QString &fileName, QString *text)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    in >> magic;
+    if (in.status() != QDataStream::Ok || magic != JOURNAL_MAGIC) {
+        return false;
+    }
+
+    quint8 type;
+    QString snapshot;
+    in >> type >> snapshot;
+    if (in.status() != QDataStream::Ok || type != SNAPSHOT_RECORD) {
+        return false;
+    }
+
+    // replay the changes on a text document, which uses the same
+    // positions as when recording and does not copy the whole text
+    QTextDocument document;
+    document.setUndoRedoEnabled(false);
+    document.setPlainText(snapshot);
+    snapshot.clear();
+
+    forever {
+        qint32 position, charsRemoved;
+        QString addedText;
+        in >> type >> position >> charsRemoved >> addedText;
+
+        // end of journal or last batch not completely written?
+        if (in.status() != QDataStream::Ok || type != CHANGE_RECORD) {
+            break;
+        }
+
+        const int lastPosition = document.characterCount() - 1;
+
+        QTextCursor cursor(&document);
+        cursor.setPosition(qBound(0, position, lastPosition));
+        cursor.setPosition(qBound(0, position + charsRemoved, lastPosition), QTextCursor::KeepAnchor);
+        cursor.insertText(addedText);
+    }
+
+    *text = document.toPlainText();
+    return true;
+}
+
+bool AutosaveJournal::flush()
+{
+    flushTimer->stop();
+
+    if (!lock.isLocked()) {
+        return false;
+    }
+
+    if (snapshotPending && !writeSnapshot()) {
+        return false;
+    }
+
+    if (pendingChanges.isEmpty()) {
+        return true;
+    }
+
+    if (file.write(pendingChanges) != pendingChanges.size()) {
+        return false;
+    }
+    syncToDisk(file);
+
+    changesSize += pendingChanges.size();
+    pendingChanges.clear();
+
+    return true;
+}
+
+bool AutosaveJournal::writeSnapshot()
+{
+    file.close();
+
+    // replace the previous journal only if the snapshot was completely written
+    QSaveFile snapshotFile(journalFileName);
+    if (!snapshotFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&snapshotFile);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << JOURNAL_MAGIC << SNAPSHOT_RECORD << snapshot;
+
+    if (!snapshotFile.commit()) {
+        return false;
+    }
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    snapshotSize = file.size();
+    changesSize = 0;
+    snapshot.clear();
+    snapshotPending = false;
+
+    return true;
+}
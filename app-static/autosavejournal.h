@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef AUTOSAVEJOURNAL_H
+#define AUTOSAVEJOURNAL_H
+
+#include <QFile>
+#include <QLockFile>
+#include <QObject>
+#include <QString>
+
+class QTimer;
+
+
+// Append-only journal of the edits of a document. The edits are
+// written in batches and replayed on top of the last snapshot of the
+// document to recover unsaved changes after a crash.
+class AutosaveJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutosaveJournal(const QString &fileName, QObject *parent = 0);
+    ~AutosaveJournal();
+
+    QString fileName() const;
+
+    bool start(const QString &text);
+    void recordChange(int position, int charsRemoved, const QString &addedText);
+
+    bool needsCompaction() const;
+    void compact(const QString &text);
+
+    void discard();
+
+    static bool isOrphaned(const QString &fileName);
+    static bool recover(const QString &fileName, QString *text);
+
+public slots:
+    bool flush();
+
+private:
+    bool writeSnapshot();
+
+    QString journalFileName;
+    QFile file;
+    QLockFile lock;
+    QTimer *flushTimer;
+    QString snapshot;
+    bool snapshotPending;
+    QByteArray pendingChanges;
+    qint64 snapshotSize;
+    qint64 changesSize;
+};
+
+#endif // AUTOSAVEJOURNAL_H
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "chunkedmarkdownconverter.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+
+#include "chunkrunner.h"
+#include "markdownblockscanner.h"
+#include "markdowndocument.h"
+#include "sourcelineannotator.h"
+
+// smaller documents are rendered in one piece
+static const int MINIMUM_CHUNK_SIZE = 64 * 1024;
+
+
+class ChunkedMarkdownDocument : public MarkdownDocument
+{
+public:
+    ChunkedMarkdownDocument(const QString &text, MarkdownConverter::ConverterOptions options) :
+        text(text),
+        options(options),
+        document(0),
+        headersDocument(0),
+        ambiguousHeaders(false),
+        mutex(QMutex::Recursive)
+    {}
+    ~ChunkedMarkdownDocument() { qDeleteAll(chunks); delete document; delete headersDocument; }
+
+    // the document in one piece is only created if needed
+    MarkdownDocument *wholeDocument(MarkdownConverter *converter)
+    {
+        QMutexLocker locker(&mutex);
+        if (!document) {
+            document = converter->createDocument(text, options);
+        }
+        return document;
+    }
+
+    // only the headers are needed for the table of contents
+    MarkdownDocument *tableOfContentsDocument(MarkdownConverter *converter)
+    {
+        QMutexLocker locker(&mutex);
+        if (!headersDocument && !ambiguousHeaders) {
+            QString headers;
+            ambiguousHeaders = !ChunkedMarkdownConverter::collectHeaders(text, &headers);
+
+            // footnotes in headers would be numbered differently
+            if (options.testFlag(MarkdownConverter::ExtraFootnoteOption) && headers.contains(QLatin1String("[^"))) {
+                ambiguousHeaders = true;
+            }
+
+            if (!ambiguousHeaders) {
+                headersDocument = converter->createDocument(headers + QLatin1Char('\n') + definitions,
+                                                            options & ~MarkdownConverter::SourceLineOption);
+            }
+        }
+        return ambiguousHeaders ? wholeDocument(converter) : headersDocument;
+    }
+
+    QString text;
+    MarkdownConverter::ConverterOptions options;
+    QVector<MarkdownDocument*> chunks;
+    QString boundaryMarker;
+    QString definitions;
+
+private:
+    MarkdownDocument *document;
+    MarkdownDocument *headersDocument;
+    bool ambiguousHeaders;
+    QMutex mutex;
+};
+
+
+namespace {
+
+// Hoedown numbers the ids of the headers from toc_0 in every chunk,
+// returns the number of header ids in the HTML
+int renumberHeaderIds(QString *html, int offset)
+{
+    static const QRegularExpression headerId(QStringLiteral("<h([1-6]) id=\"toc_(\\d+)\">"));
+
+    int count = 0;
+    QString result;
+    int position = 0;
+    QRegularExpressionMatchIterator it = headerId.globalMatch(*html);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        count++;
+        if (offset == 0) {
+            continue;
+        }
+
+        result += html->midRef(position, match.capturedStart() - position);
+        result += QStringLiteral("<h%1 id=\"toc_%2\">").arg(match.captured(1)).arg(match.captured(2).toInt() + offset);
+        position = match.capturedEnd();
+    }
+
+    if (offset > 0 && count > 0) {
+        result += html->midRef(position);
+        *html = result;
+    }
+
+    return count;
+}
+
+// Both libraries number the footnotes from 1 in every chunk, adds the
+// offset to the numbers captured by the expression and returns the
+// number of matches
+int renumberFootnotes(QString *html, const QRegularExpression &expression, int offset)
+{
+    int count = 0;
+    QString result;
+    int position = 0;
+    QRegularExpressionMatchIterator it = expression.globalMatch(*html);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        count++;
+        if (offset == 0) {
+            continue;
+        }
+
+        result += html->midRef(position, match.capturedStart() - position);
+        position = match.capturedStart();
+        for (int group = 1; group <= expression.captureCount(); ++group) {
+            result += html->midRef(position, match.capturedStart(group) - position);
+            result += QString::number(match.captured(group).toInt() + offset);
+            position = match.capturedEnd(group);
+        }
+        result += html->midRef(position, match.capturedEnd() - position);
+        position = match.capturedEnd();
+    }
+
+    if (offset > 0 && count > 0) {
+        result += html->midRef(position);
+        *html = result;
+    }
+
+    return count;
+}
+
+// removes the list of footnotes from the end of the HTML of a chunk and
+// splits it into the list items and the HTML around them
+bool takeFootnotes(QString *html, QString *listStart, QString *items, QString *listEnd)
+{
+    int start = html->lastIndexOf(QLatin1String("<div class=\"footnotes\">"));
+    if (start < 0) {
+        return false;
+    }
+    if (start > 0 && html->at(start - 1) == QLatin1Char('\n')) {
+        start--;
+    }
+
+    const QString listOpen = QStringLiteral("<ol>\n");
+    const QString itemClose = QStringLiteral("</li>\n");
+    const int itemsStart = html->indexOf(listOpen, start);
+    const int itemsEnd = html->lastIndexOf(itemClose);
+    if (itemsStart < 0 || itemsEnd < itemsStart) {
+        return false;
+    }
+
+    // the list must be the end of the HTML
+    const QString end = html->mid(itemsEnd + itemClose.length());
+    if (QString(end).remove(QLatin1Char('\n')) != QLatin1String("</ol></div>")) {
+        return false;
+    }
+
+    *listStart = html->mid(start, itemsStart + listOpen.length() - start);
+    *items = html->mid(itemsStart + listOpen.length(), itemsEnd + itemClose.length() - itemsStart - listOpen.length());
+    *listEnd = end;
+    html->truncate(start);
+    return true;
+}
+
+// the footnotes of a chunk can only be renumbered if no other chunk
+// references them
+bool referencesFootnotesInOneChunkOnly(const QString &text, const QVector<ChunkedMarkdownConverter::Chunk> &chunks)
+{
+    static const QRegularExpression reference(QStringLiteral("\\[\\^([^\\]]+)\\](?!:)"));
+
+    QHash<QString, int> chunkOfLabel;
+    for (int i = 0; i < chunks.size(); ++i) {
+        const QString chunkText = text.mid(chunks.at(i).position, chunks.at(i).length);
+
+        QRegularExpressionMatchIterator it = reference.globalMatch(chunkText);
+        while (it.hasNext()) {
+            const QString label = it.next().captured(1).simplified().toLower();
+            if (chunkOfLabel.value(label, i) != i) {
+                return false;
+            }
+            chunkOfLabel.insert(label, i);
+        }
+    }
+
+    return true;
+}
+
+}
+
+
+ChunkedMarkdownConverter::ChunkedMarkdownConverter(MarkdownConverter *converter, int chunkSize) :
+    converter(converter),
+    chunkSize(chunkSize)
+{
+    // the first document initializes global tables of the Markdown
+    // library, this must not happen on several threads at once
+    delete converter->createDocument(QStringLiteral("\n"), ConverterOptions());
+}
+
+ChunkedMarkdownConverter::~ChunkedMarkdownConverter()
+{
+    delete converter;
+}
+
+MarkdownDocument *ChunkedMarkdownConverter::createDocument(const QString &text, ConverterOptions options)
+{
+    ChunkedMarkdownDocument *doc = new ChunkedMarkdownDocument(text, options);
+
+    const QVector<Chunk> chunks = splitIntoChunks(text, chunkSizeFor(text));
+
+    // every chunk gets the footnote definitions too, the footnotes are
+    // renumbered when the HTML of the chunks is joined
+    const bool footnotes = options.testFlag(MarkdownConverter::ExtraFootnoteOption);
+
+    if (chunks.size() < 2 || !collectReferenceDefinitions(text, &doc->definitions, footnotes) ||
+        (footnotes && (!collectFootnoteDefinitions(text, &doc->definitions) ||
+                       !referencesFootnotesInOneChunkOnly(text, chunks)))) {
+        doc->wholeDocument(converter);
+        return doc;
+    }
+    const QString &definitions = doc->definitions;
+
+    // the HTML of a chunk ends in front of this paragraph
+    doc->boundaryMarker = QStringLiteral("chunkboundary");
+    while (text.contains(doc->boundaryMarker)) {
+        doc->boundaryMarker += QLatin1Char('x');
+    }
+
+    // source lines are annotated here to count them in the whole document
+    const ConverterOptions chunkOptions = options & ~MarkdownConverter::SourceLineOption;
+
+    doc->chunks.resize(chunks.size());
+    MarkdownDocument **chunkDocuments = doc->chunks.data();
+    ChunkRunner::run(chunks.size(), [&](int i) {
+        const Chunk &chunk = chunks.at(i);
+        QString chunkText = text.mid(chunk.position, chunk.length);
+        if (options.testFlag(MarkdownConverter::SourceLineOption)) {
+            chunkText = SourceLineAnnotator::annotate(chunkText, chunk.firstLine);
+        }
+
+        if (i < chunks.size() - 1) {
+            chunkText += doc->boundaryMarker + QStringLiteral("\n\n") + definitions;
+        } else {
+            // the last chunk may end in an unterminated block
+            chunkText.prepend(definitions + QLatin1Char('\n'));
+        }
+
+        chunkDocuments[i] = converter->createDocument(chunkText, chunkOptions);
+    });
+
+    return doc;
+}
+
+QString ChunkedMarkdownConverter::renderAsHtml(MarkdownDocument *document)
+{
+    ChunkedMarkdownDocument *doc = dynamic_cast<ChunkedMarkdownDocument*>(document);
+    if (!doc) {
+        return QString();
+    }
+
+    if (doc->chunks.isEmpty()) {
+        return converter->renderAsHtml(doc->wholeDocument(converter));
+    }
+
+    QVector<QString> chunkHtml(doc->chunks.size());
+    QString *results = chunkHtml.data();
+    ChunkRunner::run(doc->chunks.size(), [&](int i) {
+        results[i] = converter->renderAsHtml(doc->chunks.at(i));
+    });
+
+    static const QRegularExpression footnoteReference(QStringLiteral(
+        "<sup id=\"fnref:?(\\d+)\"><a href=\"#fn:?(\\d+)\" rel=\"footnote\">(\\d+)</a></sup>"));
+    static const QRegularExpression footnoteItem(QStringLiteral("<li id=\"fn:?(\\d+)\">"));
+    static const QRegularExpression footnoteBackLink(QStringLiteral("<a href=\"#fnref:?(\\d+)\" rev=\"footnote\">"));
+
+    const QString marker = QStringLiteral("<p>") + doc->boundaryMarker;
+
+    QString html;
+    QString footnotesStart;
+    QString footnotes;
+    QString footnotesEnd;
+    int headerCount = 0;
+    int footnoteCount = 0;
+    for (int i = 0; i < chunkHtml.size(); ++i) {
+        QString &part = results[i];
+
+        // the footnotes of the chunk are listed behind the boundary marker
+        QString listStart;
+        QString items;
+        QString listEnd;
+        const bool hasFootnotes = takeFootnotes(&part, &listStart, &items, &listEnd);
+
+        if (i < chunkHtml.size() - 1) {
+            // unexpected output, better render the document in one piece
+            const int end = part.lastIndexOf(marker);
+            if (end < 0) {
+                return converter->renderAsHtml(doc->wholeDocument(converter));
+            }
+            part.truncate(end);
+        }
+
+        headerCount += renumberHeaderIds(&part, headerCount);
+
+        const int references = renumberFootnotes(&part, footnoteReference, footnoteCount);
+        if (references > 0 && !hasFootnotes) {
+            return converter->renderAsHtml(doc->wholeDocument(converter));
+        }
+        if (hasFootnotes) {
+            renumberFootnotes(&items, footnoteBackLink, footnoteCount);
+            footnoteCount += renumberFootnotes(&items, footnoteItem, footnoteCount);
+            footnotes += items;
+            if (footnotesStart.isEmpty()) {
+                footnotesStart = listStart;
+                footnotesEnd = listEnd;
+            }
+        }
+
+        html += part;
+    }
+
+    if (footnoteCount > 0) {
+        html += footnotesStart + footnotes + footnotesEnd;
+    }
+
+    return html;
+}
+
+QString ChunkedMarkdownConverter::renderAsTableOfContents(MarkdownDocument *document)
+{
+    ChunkedMarkdownDocument *doc = dynamic_cast<ChunkedMarkdownDocument*>(document);
+    if (!doc) {
+        return QString();
+    }
+
+    if (doc->chunks.isEmpty()) {
+        return converter->renderAsTableOfContents(doc->wholeDocument(converter));
+    }
+
+    // the nesting of the entries depends on the headers of all chunks
+    return converter->renderAsTableOfContents(doc->tableOfContentsDocument(converter));
+}
+
+Template *ChunkedMarkdownConverter::templateRenderer() const
+{
+    return converter->templateRenderer();
+}
+
+MarkdownConverter::ConverterOptions ChunkedMarkdownConverter::supportedOptions() const
+{
+    return converter->supportedOptions();
+}
+
+QVector<ChunkedMarkdownConverter::Chunk> ChunkedMarkdownConverter::splitIntoChunks(const QString &text, int chunkSize)
+{
+    QVector<Chunk> chunks;
+
+    int chunkStart = 0;
+    int chunkFirstLine = 1;
+    int position = 0;
+    int lineNumber = 1;
+    MarkdownBlockScanner scanner;
+
+    while (position < text.length()) {
+        int lineEnd = text.indexOf(QLatin1Char('\n'), position);
+        if (lineEnd < 0) {
+            lineEnd = text.length();
+        }
+
+        const QStringRef line = text.midRef(position, lineEnd - position);
+
+        // only split where nothing above can continue into the next block
+        if (position - chunkStart >= chunkSize && scanner.isChunkBoundary(line)) {
+            chunks.append(Chunk { chunkStart, position - chunkStart, chunkFirstLine });
+            chunkStart = position;
+            chunkFirstLine = lineNumber;
+        }
+        scanner.addLine(line);
+
+        position = lineEnd + 1;
+        lineNumber++;
+    }
+
+    if (chunkStart < text.length() || chunks.isEmpty()) {
+        chunks.append(Chunk { chunkStart, text.length() - chunkStart, chunkFirstLine });
+    }
+
+    return chunks;
+}
+
+bool ChunkedMarkdownConverter::collectReferenceDefinitions(const QString &text, QString *definitions, bool footnotes)
+{
+    static const QRegularExpression definition(QStringLiteral("^ {0,3}\\[([^\\]]+)\\]:[ \\t]*\\S"));
+    static const QRegularExpression titleLine(QStringLiteral("^[ \\t]+[\"'(]"));
+
+    QSet<QString> labels;
+    bool insideCodeFence = false;
+    bool previousLineDefinition = false;
+
+    foreach (const QString &line, text.split(QLatin1Char('\n'))) {
+        if (MarkdownBlockScanner::isCodeFence(QStringRef(&line))) {
+            insideCodeFence = !insideCodeFence;
+            previousLineDefinition = false;
+            continue;
+        }
+
+        const QRegularExpressionMatch match = definition.match(line);
+        if (match.hasMatch() && !(footnotes && match.captured(1).startsWith(QLatin1Char('^')))) {
+            // the Markdown libraries disagree about definitions in code
+            // blocks and which of two definitions of a label is used
+            const QString label = match.captured(1).simplified().toLower();
+            if (insideCodeFence || labels.contains(label)) {
+                return false;
+            }
+            labels.insert(label);
+
+            *definitions += line + QLatin1Char('\n');
+            previousLineDefinition = true;
+            continue;
+        }
+
+        // the title of a definition may follow on the next line
+        if (previousLineDefinition && titleLine.match(line).hasMatch()) {
+            *definitions += line + QLatin1Char('\n');
+        }
+        previousLineDefinition = false;
+    }
+
+    return true;
+}
+
+bool ChunkedMarkdownConverter::collectFootnoteDefinitions(const QString &text, QString *definitions)
+{
+    static const QRegularExpression footnote(QStringLiteral("^ {0,3}\\[\\^([^\\]]+)\\]:"));
+    static const QRegularExpression definition(QStringLiteral("^ {0,3}\\[[^\\]]+\\]:"));
+
+    QSet<QString> labels;
+    bool insideCodeFence = false;
+
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    for (int i = 0; i < lines.count(); ++i) {
+        const QString &line = lines.at(i);
+
+        if (MarkdownBlockScanner::isCodeFence(QStringRef(&line))) {
+            insideCodeFence = !insideCodeFence;
+            continue;
+        }
+
+        const QRegularExpressionMatch match = footnote.match(line);
+        if (!match.hasMatch()) {
+            continue;
+        }
+
+        // the Markdown libraries disagree about footnotes continued on
+        // the next lines, so only take footnotes of a single line which
+        // reference no other footnote
+        const QString label = match.captured(1).simplified().toLower();
+        const bool lastLine = i + 1 == lines.count() || lines.at(i + 1).trimmed().isEmpty() ||
+                              definition.match(lines.at(i + 1)).hasMatch();
+        if (insideCodeFence || labels.contains(label) || !lastLine ||
+            line.indexOf(QLatin1String("[^"), match.capturedEnd()) >= 0) {
+            return false;
+        }
+        labels.insert(label);
+
+        *definitions += line + QStringLiteral("\n\n");
+    }
+
+    return true;
+}
+
+bool ChunkedMarkdownConverter::collectHeaders(const QString &text, QString *headers)
+{
+    static const QRegularExpression setextUnderline(QStringLiteral("^(=+|-+)[ \\t]*$"));
+    static const QRegularExpression quotedHeader(QStringLiteral("^[ \\t]*(>[ \\t]*)+#"));
+
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    MarkdownBlockScanner scanner;
+
+    for (int i = 0; i < lines.count(); ++i) {
+        const QStringRef line(&lines.at(i));
+
+        if (!scanner.isInsideCodeOrHtml() && !MarkdownBlockScanner::isIndented(line)) {
+            const bool underlined = i + 1 < lines.count() && !line.trimmed().isEmpty() &&
+                                    setextUnderline.match(lines.at(i + 1)).hasMatch();
+
+            if (line.startsWith(QLatin1Char('#')) || underlined) {
+                // the Markdown libraries disagree about headers inside
+                // of other blocks, so only take the unambiguous ones
+                if (!scanner.isBlockStart(line) ||
+                    (underlined && !MarkdownBlockScanner::startsTopLevelBlock(line))) {
+                    return false;
+                }
+
+                *headers += lines.at(i) + QLatin1Char('\n');
+                if (underlined) {
+                    *headers += lines.at(i + 1) + QLatin1Char('\n');
+                }
+                *headers += QLatin1Char('\n');
+            } else if (quotedHeader.match(lines.at(i)).hasMatch()) {
+                return false;
+            }
+        }
+
+        scanner.addLine(line);
+    }
+
+    return true;
+}
+
+int ChunkedMarkdownConverter::chunkSizeFor(const QString &text) const
+{
+    if (chunkSize > 0) {
+        return chunkSize;
+    }
+
+    // a few chunks per thread even out differences in render time
+    const int threads = qMax(1, QThread::idealThreadCount());
+    return qMax(MINIMUM_CHUNK_SIZE, text.length() / (4 * threads));
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CHUNKEDMARKDOWNCONVERTER_H
+#define CHUNKEDMARKDOWNCONVERTER_H
+
+#include "markdownconverter.h"
+
+#include <QVector>
+
+
+// Renders large documents in parts on a thread pool. The document is
+// only split at blank lines in front of a top-level paragraph or header
+// and every part gets the link reference definitions of the whole
+// document, so the concatenated HTML equals the HTML of the whole
+// document. Footnotes are renumbered and listed once at the end, a
+// footnote referenced in several parts makes the document render in
+// one piece. The table of contents is rendered from a document of only
+// the headers.
+class ChunkedMarkdownConverter : public MarkdownConverter
+{
+public:
+    struct Chunk
+    {
+        int position;
+        int length;
+        int firstLine;
+    };
+
+    // takes ownership of the converter, a chunk size of 0 is chosen
+    // from the document size and the number of processors
+    explicit ChunkedMarkdownConverter(MarkdownConverter *converter, int chunkSize = 0);
+    ~ChunkedMarkdownConverter();
+
+    virtual MarkdownDocument *createDocument(const QString &text, ConverterOptions options);
+    virtual QString renderAsHtml(MarkdownDocument *document);
+    virtual QString renderAsTableOfContents(MarkdownDocument *document);
+
+    virtual Template *templateRenderer() const;
+
+    virtual ConverterOptions supportedOptions() const;
+
+    static QVector<Chunk> splitIntoChunks(const QString &text, int chunkSize);
+    static bool collectReferenceDefinitions(const QString &text, QString *definitions, bool footnotes = false);
+    static bool collectFootnoteDefinitions(const QString &text, QString *definitions);
+    static bool collectHeaders(const QString &text, QString *headers);
+
+private:
+    int chunkSizeFor(const QString &text) const;
+
+    MarkdownConverter *converter;
+    int chunkSize;
+};
+
+#endif // CHUNKEDMARKDOWNCONVERTER_H
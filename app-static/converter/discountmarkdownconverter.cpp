@@ -39,6 +39,7 @@ extern "C" {
 }
 
 #include "markdowndocument.h"
+#include "sourcelineannotator.h"
 #include "template/htmltemplate.h"
 
 class DiscountMarkdownDocument : public MarkdownDocument
@@ -63,7 +64,9 @@ MarkdownDocument *DiscountMarkdownConverter::createDocument(const QString &text,
     MMIOT *doc = 0;
 
     if (text.length() > 0) {
-        QString markdownText(text);
+        QString markdownText = options.testFlag(MarkdownConverter::SourceLineOption) ?
+                                   SourceLineAnnotator::annotate(text)
+                                 : text;
 
         // text has to always end with a line break,
         // otherwise characters are missing in HTML
@@ -133,7 +136,8 @@ MarkdownConverter::ConverterOptions DiscountMarkdownConverter::supportedOptions(
            MarkdownConverter::NoDefinitionListOption |
            MarkdownConverter::NoSmartypantsOption |
            MarkdownConverter::ExtraFootnoteOption |
-           MarkdownConverter::NoSuperscriptOption;
+           MarkdownConverter::NoSuperscriptOption |
+           MarkdownConverter::SourceLineOption;
 }
 
 unsigned long DiscountMarkdownConverter::translateConverterOptions(ConverterOptions options) const
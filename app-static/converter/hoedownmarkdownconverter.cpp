@@ -42,6 +42,7 @@ extern "C" {
 }
 
 #include "markdowndocument.h"
+#include "sourcelineannotator.h"
 #include "template/htmltemplate.h"
 
 class HoedownMarkdownDocument : public MarkdownDocument
@@ -71,7 +72,9 @@ MarkdownDocument *HoedownMarkdownConverter::createDocument(const QString &text,
     hoedown_buffer *doc = 0;
 
     if (text.length() > 0) {
-        QString markdownText(text);
+        QString markdownText = options.testFlag(MarkdownConverter::SourceLineOption) ?
+                                   SourceLineAnnotator::annotate(text)
+                                 : text;
 
         QByteArray utf8Data = markdownText.toUtf8();
         doc = hoedown_buffer_new(utf8Data.length());
@@ -148,7 +151,8 @@ MarkdownConverter::ConverterOptions HoedownMarkdownConverter::supportedOptions()
     return MarkdownConverter::AutolinkOption |
            MarkdownConverter::NoStrikethroughOption |
            MarkdownConverter::ExtraFootnoteOption |
-           MarkdownConverter::NoSuperscriptOption;
+           MarkdownConverter::NoSuperscriptOption |
+           MarkdownConverter::SourceLineOption;
 }
 
 unsigned long HoedownMarkdownConverter::translateConverterOptions(ConverterOptions options) const
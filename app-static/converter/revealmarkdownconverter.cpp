@@ -3,12 +3,13 @@
 #include <QStringList>
 
 #include "markdowndocument.h"
+#include "slidelinemapping.h"
 #include "template/presentationtemplate.h"
 
 class RevealMarkdownDocument : public MarkdownDocument
 {
 public:
-    QString markdownText;
+    QString html;
 };
 
 RevealMarkdownConverter::RevealMarkdownConverter()
@@ -17,10 +18,51 @@ RevealMarkdownConverter::RevealMarkdownConverter()
 
 MarkdownDocument *RevealMarkdownConverter::createDocument(const QString &text, MarkdownConverter::ConverterOptions options)
 {
-    Q_UNUSED(options)
-
     RevealMarkdownDocument *doc = new RevealMarkdownDocument();
-    doc->markdownText = text;
+    if (text.isEmpty()) {
+        return doc;
+    }
+
+    // split slides using the same rules as the view synchronizer
+    SlideLineMapping mapping;
+    mapping.build(text);
+
+    QStringList lines = SlideLineMapping::splitLines(text);
+    QVector<QPair<int, int> > slides = mapping.slides();
+    QVector<int> separatorLines = mapping.separatorLines();
+
+    QMutexLocker locker(&cacheMutex);
+    QHash<QString, QString> renderedSlides;
+
+    for (int i = 0; i < slides.count(); ++i) {
+        int firstLine = i > 0 ? separatorLines.at(i-1) + 1 : 0;
+        int lastLine = i < separatorLines.count() ? separatorLines.at(i) - 1 : lines.count() - 1;
+        QString markdown = QStringList(lines.mid(firstLine, lastLine - firstLine + 1)).join('\n');
+
+        // only render slides that changed since the last call
+        QString key = QString::number(int(options)) + QLatin1Char('\n') + markdown;
+        QString slideHtml = slideCache.contains(key) ? slideCache.value(key) : renderSlide(markdown, options);
+        renderedSlides.insert(key, slideHtml);
+
+        // vertical slides are nested in a section of their horizontal slide
+        const QPair<int, int> &slide = slides.at(i);
+        bool lastOfStack = (i + 1 == slides.count() || slides.at(i+1).second == 0);
+        bool stacked = slide.second > 0 || !lastOfStack;
+
+        if (stacked && slide.second == 0) {
+            doc->html += QStringLiteral("<section>\n");
+        }
+
+        doc->html += QStringLiteral("<section>\n") + slideHtml + QStringLiteral("\n</section>\n");
+
+        if (stacked && lastOfStack) {
+            doc->html += QStringLiteral("</section>\n");
+        }
+    }
+
+    // forget slides that no longer exist
+    slideCache = renderedSlides;
+
     return doc;
 }
 
@@ -31,7 +73,7 @@ QString RevealMarkdownConverter::renderAsHtml(MarkdownDocument *document)
     if (document) {
         RevealMarkdownDocument *doc = dynamic_cast<RevealMarkdownDocument*>(document);
         if (doc) {
-            html = doc->markdownText;
+            html = doc->html;
         }
     }
 
@@ -53,5 +95,20 @@ Template *RevealMarkdownConverter::templateRenderer() const
 
 MarkdownConverter::ConverterOptions RevealMarkdownConverter::supportedOptions() const
 {
-    return 0;
+    return MarkdownConverter::AutolinkOption |
+           MarkdownConverter::NoStrikethroughOption |
+           MarkdownConverter::NoAlphaListOption |
+           MarkdownConverter::NoDefinitionListOption |
+           MarkdownConverter::NoSmartypantsOption |
+           MarkdownConverter::ExtraFootnoteOption |
+           MarkdownConverter::NoSuperscriptOption;
+}
+
+QString RevealMarkdownConverter::renderSlide(const QString &markdown, ConverterOptions options)
+{
+    MarkdownDocument *document = slideConverter.createDocument(markdown, options);
+    QString html = slideConverter.renderAsHtml(document);
+    delete document;
+
+    return html;
 }
@@ -2,6 +2,10 @@
 #define REVEALMARKDOWNCONVERTER_H
 
 #include "markdownconverter.h"
+#include "discountmarkdownconverter.h"
+
+#include <QHash>
+#include <QMutex>
 
 class RevealMarkdownConverter : public MarkdownConverter
 {
@@ -15,6 +19,13 @@ public:
     virtual Template *templateRenderer() const;
 
     virtual ConverterOptions supportedOptions() const;
+
+private:
+    QString renderSlide(const QString &markdown, ConverterOptions options);
+
+    DiscountMarkdownConverter slideConverter;
+    QHash<QString, QString> slideCache;
+    QMutex cacheMutex;
 };
 
 #endif // REVEALMARKDOWNCONVERTER_H
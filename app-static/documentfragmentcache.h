@@ -0,0 +1,39 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DOCUMENTFRAGMENTCACHE_H
+#define DOCUMENTFRAGMENTCACHE_H
+
+#include <QtCore/qobject.h>
+
+
+// The part of the fragment cache the preview page of a document can
+// write to from JavaScript. Fragments are stored in the scope of the
+// document only.
+class DocumentFragmentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentFragmentCache(quint64 scopeId, QObject *parent = 0);
+
+    Q_INVOKABLE void insert(const QString &kind, const QString &source, const QString &fragment);
+
+private:
+    quint64 scopeId;
+};
+
+#endif // DOCUMENTFRAGMENTCACHE_H
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "fragmentcache.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qregularexpression.h>
+
+// the size of the fragments is counted in characters
+static const int DEFAULT_MAXIMUM_SIZE = 16 * 1024 * 1024;
+
+static thread_local quint64 currentScopeId = 0;
+
+
+FragmentCache::Scope::Scope(quint64 scopeId) :
+    previousScopeId(currentScopeId)
+{
+    currentScopeId = scopeId;
+}
+
+FragmentCache::Scope::~Scope()
+{
+    currentScopeId = previousScopeId;
+}
+
+
+FragmentCache::FragmentCache(int maximumSize, QObject *parent) :
+    QObject(parent),
+    fragments(maximumSize)
+{
+}
+
+FragmentCache *FragmentCache::instance()
+{
+    static FragmentCache cache(DEFAULT_MAXIMUM_SIZE);
+    return &cache;
+}
+
+quint64 FragmentCache::createScopeId()
+{
+    // 0 is the scope outside of any document
+    static QAtomicInteger<quint64> lastScopeId(0);
+    return lastScopeId.fetchAndAddRelaxed(1) + 1;
+}
+
+QString FragmentCache::find(const QString &kind, const QString &source) const
+{
+    QMutexLocker locker(&mutex);
+
+    QString *fragment = fragments.object(key(kind, source));
+    return fragment ? *fragment : QString();
+}
+
+void FragmentCache::insert(const QString &kind, const QString &source, const QString &fragment)
+{
+    if (fragment.isEmpty() || !isSafeFragment(fragment)) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    fragments.insert(key(kind, source), new QString(fragment), qMax(1, fragment.size()));
+}
+
+void FragmentCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    fragments.clear();
+}
+
+QString FragmentCache::textFromHtml(const QString &html)
+{
+    return QString(html).replace(QLatin1String("&lt;"), QLatin1String("<"))
+                        .replace(QLatin1String("&gt;"), QLatin1String(">"))
+                        .replace(QLatin1String("&quot;"), QLatin1String("\""))
+                        .replace(QLatin1String("&#39;"), QLatin1String("'"))
+                        .replace(QLatin1String("&amp;"), QLatin1String("&"));
+}
+
+bool FragmentCache::isSafeFragment(const QString &fragment)
+{
+    // text is escaped in the fragments, so every '<' starts a tag
+    static const QRegularExpression activeContent(
+        QStringLiteral("<\\s*(script|iframe|frame|object|embed|applet|link|meta|base|form)\\b"
+                       "|<[^>]*\\son\\w+\\s*="
+                       "|<[^>]*(javascript|vbscript|data)\\s*:"),
+        QRegularExpression::CaseInsensitiveOption);
+
+    return !activeContent.match(fragment).hasMatch();
+}
+
+QString FragmentCache::key(const QString &kind, const QString &source)
+{
+    return QString::number(currentScopeId) + QLatin1Char('\n') +
+           kind + QLatin1Char('\n') + source;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAGMENTCACHE_H
+#define FRAGMENTCACHE_H
+
+#include <QtCore/qcache.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+
+
+// Keeps rendered HTML fragments (e.g. typeset formulas) keyed by
+// the kind of fragment and its source, so unchanged fragments don't
+// need to be rendered again. The cache is shared by all windows, but
+// the fragments of each document are kept apart in their own scope.
+class FragmentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // makes the fragments of a document the current ones on this thread
+    class Scope
+    {
+    public:
+        explicit Scope(quint64 scopeId);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        quint64 previousScopeId;
+    };
+
+    explicit FragmentCache(int maximumSize, QObject *parent = 0);
+
+    static FragmentCache *instance();
+
+    // returns an id for the scope of a document, which is never
+    // used again (unlike the address of a destroyed document)
+    static quint64 createScopeId();
+
+    QString find(const QString &kind, const QString &source) const;
+    void insert(const QString &kind, const QString &source, const QString &fragment);
+
+    void clear();
+
+    // returns the text of the HTML source as seen by the browser
+    static QString textFromHtml(const QString &html);
+
+    // fragments come from scripts of the page, so they must not
+    // contain anything that runs a script when inserted again
+    static bool isSafeFragment(const QString &fragment);
+
+private:
+    static QString key(const QString &kind, const QString &source);
+
+    mutable QMutex mutex;
+    QCache<QString, QString> fragments;
+};
+
+#endif // FRAGMENTCACHE_H
@@ -18,9 +18,12 @@
 
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QTextBlock>
 #include <QWebFrame>
 #include <QWebView>
 
+#include <algorithm>
+
 
 HtmlViewSynchronizer::HtmlViewSynchronizer(QWebView *webView, QPlainTextEdit *editor) :
     ViewSynchronizer(webView, editor),
@@ -33,6 +36,10 @@ HtmlViewSynchronizer::HtmlViewSynchronizer(QWebView *webView, QPlainTextEdit *ed
     // restore scrollbar position after content size changed
     connect(webView->page()->mainFrame(), SIGNAL(contentsSizeChanged(QSize)),
             this, SLOT(htmlContentSizeChanged()));
+
+    // collect positions of the source line anchors after layout
+    connect(webView, SIGNAL(loadFinished(bool)),
+            this, SLOT(updateSourceLineOffsets()));
 }
 
 HtmlViewSynchronizer::~HtmlViewSynchronizer()
@@ -41,11 +48,15 @@ HtmlViewSynchronizer::~HtmlViewSynchronizer()
 
 void HtmlViewSynchronizer::webViewScrolled()
 {
-    double factor = (double)m_editor->verticalScrollBar()->maximum() /
-                    m_webView->page()->mainFrame()->scrollBarMaximum(Qt::Vertical);
     int value = m_webView->page()->mainFrame()->scrollBarValue(Qt::Vertical);
 
-    m_editor->verticalScrollBar()->setValue(qRound(value * factor));
+    if (anchorLines.isEmpty()) {
+        double factor = (double)m_editor->verticalScrollBar()->maximum() /
+                        m_webView->page()->mainFrame()->scrollBarMaximum(Qt::Vertical);
+        m_editor->verticalScrollBar()->setValue(qRound(value * factor));
+    } else {
+        m_editor->verticalScrollBar()->setValue(sourceLineToEditorScrollValue(offsetToSourceLine(value)));
+    }
 
     // remember new vertical scrollbar position of markdown editor
     rememberScrollBarPos();
@@ -53,15 +64,23 @@ void HtmlViewSynchronizer::webViewScrolled()
 
 void HtmlViewSynchronizer::scrollValueChanged(int value)
 {
-    int webMax = m_webView->page()->mainFrame()->scrollBarMaximum(Qt::Vertical);
-    int textMax = m_editor->verticalScrollBar()->maximum();
-    double factor = (double)webMax / textMax;
+    if (anchorLines.isEmpty()) {
+        int webMax = m_webView->page()->mainFrame()->scrollBarMaximum(Qt::Vertical);
+        int textMax = m_editor->verticalScrollBar()->maximum();
+        double factor = (double)webMax / textMax;
 
-    m_webView->page()->mainFrame()->setScrollBarValue(Qt::Vertical, qRound(value * factor));
+        m_webView->page()->mainFrame()->setScrollBarValue(Qt::Vertical, qRound(value * factor));
+    } else {
+        int offset = sourceLineToOffset(editorScrollValueToSourceLine(value));
+        m_webView->page()->mainFrame()->setScrollBarValue(Qt::Vertical, offset);
+    }
 }
 
 void HtmlViewSynchronizer::htmlContentSizeChanged()
 {
+    // images or math change the positions of the anchors
+    updateSourceLineOffsets();
+
     if (scrollBarPos > 0) {
         // restore previous scrollbar position
         scrollValueChanged(scrollBarPos);
@@ -72,3 +91,109 @@ void HtmlViewSynchronizer::rememberScrollBarPos()
 {
     scrollBarPos = m_editor->verticalScrollBar()->value();
 }
+
+void HtmlViewSynchronizer::updateSourceLineOffsets()
+{
+    static const QString script = QStringLiteral(
+        "(function() {"
+        "  var anchors = document.querySelectorAll('[data-source-line]');"
+        "  var result = [];"
+        "  for (var i = 0; i < anchors.length; ++i) {"
+        "    result.push(parseInt(anchors[i].getAttribute('data-source-line')),"
+        "                anchors[i].getBoundingClientRect().top + window.pageYOffset);"
+        "  }"
+        "  return result;"
+        "})();");
+
+    QWebFrame *frame = m_webView->page()->mainFrame();
+    QVariantList result = frame->evaluateJavaScript(script).toList();
+
+    anchorLines.clear();
+    anchorOffsets.clear();
+
+    if (result.isEmpty()) {
+        return;
+    }
+
+    // start and end of the document
+    anchorLines.append(0);
+    anchorOffsets.append(0);
+
+    for (int i = 0; i + 1 < result.count(); i += 2) {
+        // anchors use line numbers starting at 1
+        int line = result.at(i).toInt() - 1;
+        int offset = qRound(result.at(i + 1).toDouble());
+
+        // keep both columns sorted
+        if (line > anchorLines.last() && offset >= anchorOffsets.last()) {
+            anchorLines.append(line);
+            anchorOffsets.append(offset);
+        }
+    }
+
+    int lastLine = m_editor->document()->blockCount();
+    int lastOffset = frame->contentsSize().height();
+    if (lastLine > anchorLines.last() && lastOffset >= anchorOffsets.last()) {
+        anchorLines.append(lastLine);
+        anchorOffsets.append(lastOffset);
+    }
+}
+
+double HtmlViewSynchronizer::editorScrollValueToSourceLine(int value) const
+{
+    // the editor scrolls by visual lines, which differ
+    // from source lines if word wrap is enabled
+    QTextBlock block = m_editor->document()->findBlockByLineNumber(value);
+    if (!block.isValid()) {
+        return m_editor->document()->blockCount();
+    }
+
+    int lineCount = qMax(1, block.lineCount());
+    return block.blockNumber() + double(value - block.firstLineNumber()) / lineCount;
+}
+
+int HtmlViewSynchronizer::sourceLineToEditorScrollValue(double line) const
+{
+    QTextBlock block = m_editor->document()->findBlockByNumber(int(line));
+    if (!block.isValid()) {
+        return m_editor->verticalScrollBar()->maximum();
+    }
+
+    int lineCount = qMax(1, block.lineCount());
+    return block.firstLineNumber() + qRound((line - block.blockNumber()) * lineCount);
+}
+
+int HtmlViewSynchronizer::sourceLineToOffset(double line) const
+{
+    // find the anchors before and after the line
+    int index = std::upper_bound(anchorLines.constBegin(), anchorLines.constEnd(), line) - anchorLines.constBegin();
+    if (index == 0) {
+        return anchorOffsets.first();
+    }
+    if (index == anchorLines.count()) {
+        return anchorOffsets.last();
+    }
+
+    // interpolate between both anchors
+    double fraction = (line - anchorLines.at(index - 1)) / (anchorLines.at(index) - anchorLines.at(index - 1));
+    return qRound(anchorOffsets.at(index - 1) + fraction * (anchorOffsets.at(index) - anchorOffsets.at(index - 1)));
+}
+
+double HtmlViewSynchronizer::offsetToSourceLine(int offset) const
+{
+    int index = std::upper_bound(anchorOffsets.constBegin(), anchorOffsets.constEnd(), offset) - anchorOffsets.constBegin();
+    if (index == 0) {
+        return anchorLines.first();
+    }
+    if (index == anchorOffsets.count()) {
+        return anchorLines.last();
+    }
+
+    int height = anchorOffsets.at(index) - anchorOffsets.at(index - 1);
+    if (height == 0) {
+        return anchorLines.at(index - 1);
+    }
+
+    double fraction = double(offset - anchorOffsets.at(index - 1)) / height;
+    return anchorLines.at(index - 1) + fraction * (anchorLines.at(index) - anchorLines.at(index - 1));
+}
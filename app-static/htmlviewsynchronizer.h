@@ -19,6 +19,8 @@
 
 #include "viewsynchronizer.h"
 
+#include <QVector>
+
 
 class HtmlViewSynchronizer : public ViewSynchronizer
 {
@@ -35,9 +37,19 @@ public slots:
 private slots:
     void scrollValueChanged(int value);
     void htmlContentSizeChanged();
+    void updateSourceLineOffsets();
 
 private:
+    double editorScrollValueToSourceLine(int value) const;
+    int sourceLineToEditorScrollValue(double line) const;
+    int sourceLineToOffset(double line) const;
+    double offsetToSourceLine(int offset) const;
+
     int scrollBarPos;
+
+    // sorted (source line, y-offset) pairs of the anchors in the preview
+    QVector<int> anchorLines;
+    QVector<int> anchorOffsets;
 };
 
 #endif // HTMLVIEWSYNCHRONIZER_H
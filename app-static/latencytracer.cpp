@@ -0,0 +1,218 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "latencytracer.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+static const int MAXIMUM_TRACES = 256;
+
+
+LatencyTracer::LatencyTracer(int windowSize) :
+    enabled(0),
+    windowSize(windowSize)
+{
+    timer.start();
+}
+
+LatencyTracer *LatencyTracer::instance()
+{
+    static LatencyTracer tracer;
+    return &tracer;
+}
+
+void LatencyTracer::setEnabled(bool enabled)
+{
+    this->enabled.store(enabled ? 1 : 0);
+}
+
+bool LatencyTracer::isEnabled() const
+{
+    return enabled.load() != 0;
+}
+
+void LatencyTracer::mark(const QTextDocument *document, int revision, Stage stage)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    mark(document, revision, stage, timer.nsecsElapsed() / 1000);
+}
+
+void LatencyTracer::mark(const QTextDocument *document, int revision, Stage stage, qint64 timestamp)
+{
+    QMutexLocker locker(&mutex);
+
+    const TraceKey key(document, revision);
+    QMap<TraceKey, Trace>::iterator it = traces.find(key);
+    if (it == traces.end()) {
+        // only an edit starts a new trace
+        if (!startsTrace(stage)) {
+            return;
+        }
+
+        Trace trace;
+        trace.edited = timestamp;
+        std::fill(trace.timestamps, trace.timestamps + StageCount, -1);
+        it = traces.insert(key, trace);
+
+        traceOrder.enqueue(key);
+        if (traceOrder.count() > MAXIMUM_TRACES) {
+            traces.remove(traceOrder.dequeue());
+        }
+    }
+
+    // a stage might run several times for the same revision
+    // (e.g. the preview is regenerated because an option changed)
+    Trace &trace = it.value();
+    if (trace.timestamps[stage] >= 0) {
+        return;
+    }
+    trace.timestamps[stage] = timestamp;
+
+    // latency since the last stage of the same path reached by this revision
+    qint64 previous = trace.edited;
+    for (int s = stage - 1; s >= firstStage(stage); --s) {
+        if (trace.timestamps[s] >= 0) {
+            previous = trace.timestamps[s];
+            break;
+        }
+    }
+
+    addSample(stageSamples[stage], timestamp - previous);
+    addSample(totalSamples[stage], timestamp - trace.edited);
+}
+
+LatencyTracer::Statistics LatencyTracer::stageStatistics(Stage stage) const
+{
+    QMutexLocker locker(&mutex);
+    return statistics(stageSamples[stage]);
+}
+
+LatencyTracer::Statistics LatencyTracer::totalStatistics(Stage stage) const
+{
+    QMutexLocker locker(&mutex);
+    return statistics(totalSamples[stage]);
+}
+
+QByteArray LatencyTracer::toJson() const
+{
+    QJsonArray stages;
+    for (int i = 0; i < StageCount; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const Statistics sinceStage = stageStatistics(stage);
+        const Statistics sinceEdit = totalStatistics(stage);
+
+        QJsonObject stageLatency;
+        stageLatency["p50"] = sinceStage.p50;
+        stageLatency["p95"] = sinceStage.p95;
+        stageLatency["p99"] = sinceStage.p99;
+
+        QJsonObject totalLatency;
+        totalLatency["p50"] = sinceEdit.p50;
+        totalLatency["p95"] = sinceEdit.p95;
+        totalLatency["p99"] = sinceEdit.p99;
+
+        QJsonObject object;
+        object["name"] = stageName(stage);
+        object["count"] = sinceStage.count;
+        object["sinceStage"] = stageLatency;
+        object["sinceEdit"] = totalLatency;
+        stages.append(object);
+    }
+
+    QJsonObject root;
+    root["unit"] = QStringLiteral("us");
+    root["window"] = windowSize;
+    root["stages"] = stages;
+
+    return QJsonDocument(root).toJson();
+}
+
+bool LatencyTracer::exportToFile(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    return file.write(toJson()) >= 0;
+}
+
+QString LatencyTracer::stageName(Stage stage)
+{
+    switch (stage) {
+    case PreviewRequested:   return QStringLiteral("preview-requested");
+    case PreviewStarted:     return QStringLiteral("preview-started");
+    case PreviewParsed:      return QStringLiteral("preview-parsed");
+    case PreviewRendered:    return QStringLiteral("preview-rendered");
+    case PreviewReceived:    return QStringLiteral("preview-received");
+    case PreviewLoaded:      return QStringLiteral("preview-loaded");
+    case HighlightRequested: return QStringLiteral("highlight-requested");
+    case HighlightStarted:   return QStringLiteral("highlight-started");
+    case HighlightParsed:    return QStringLiteral("highlight-parsed");
+    case HighlightApplied:   return QStringLiteral("highlight-applied");
+    default:                 return QString();
+    }
+}
+
+bool LatencyTracer::startsTrace(Stage stage)
+{
+    return stage == PreviewRequested || stage == HighlightRequested;
+}
+
+LatencyTracer::Stage LatencyTracer::firstStage(Stage stage)
+{
+    return stage < HighlightRequested ? PreviewRequested : HighlightRequested;
+}
+
+void LatencyTracer::addSample(Samples &samples, qint64 value)
+{
+    // keep only the last samples, so the percentiles follow recent changes
+    if (samples.values.count() < windowSize) {
+        samples.values.append(value);
+    } else {
+        samples.values[samples.next] = value;
+        samples.next = (samples.next + 1) % windowSize;
+    }
+}
+
+LatencyTracer::Statistics LatencyTracer::statistics(const Samples &samples)
+{
+    Statistics result = { samples.values.count(), 0, 0, 0 };
+    if (samples.values.isEmpty()) {
+        return result;
+    }
+
+    QVector<qint64> values = samples.values;
+    std::sort(values.begin(), values.end());
+
+    // nearest-rank percentiles
+    auto percentile = [&values](int p) {
+        const int rank = (p * values.count() + 99) / 100;
+        return values.at(qMax(rank, 1) - 1);
+    };
+
+    result.p50 = percentile(50);
+    result.p95 = percentile(95);
+    result.p99 = percentile(99);
+    return result;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qvector.h>
+
+class QTextDocument;
+
+
+// Traces the time from an edit of a document to the updated preview
+// and syntax highlighting. Every stage of both paths is marked with the
+// revision of the document it works on. For each stage the tracer keeps
+// the latencies of the last edits, since the previous stage and since
+// the edit, and reports their percentiles.
+class LatencyTracer
+{
+public:
+    enum Stage {
+        PreviewRequested,
+        PreviewStarted,
+        PreviewParsed,
+        PreviewRendered,
+        PreviewReceived,
+        PreviewLoaded,
+        HighlightRequested,
+        HighlightStarted,
+        HighlightParsed,
+        HighlightApplied,
+        StageCount
+    };
+
+    // latencies in microseconds
+    struct Statistics
+    {
+        int count;
+        qint64 p50;
+        qint64 p95;
+        qint64 p99;
+    };
+
+    explicit LatencyTracer(int windowSize = 1000);
+
+    static LatencyTracer *instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void mark(const QTextDocument *document, int revision, Stage stage);
+    void mark(const QTextDocument *document, int revision, Stage stage, qint64 timestamp);
+
+    Statistics stageStatistics(Stage stage) const;
+    Statistics totalStatistics(Stage stage) const;
+
+    QByteArray toJson() const;
+    bool exportToFile(const QString &fileName) const;
+
+    static QString stageName(Stage stage);
+
+private:
+    struct Samples
+    {
+        Samples() : next(0) {}
+
+        QVector<qint64> values;
+        int next;
+    };
+
+    struct Trace
+    {
+        qint64 edited;
+        qint64 timestamps[StageCount];
+    };
+
+    typedef QPair<const QTextDocument*, int> TraceKey;
+
+    static bool startsTrace(Stage stage);
+    static Stage firstStage(Stage stage);
+    void addSample(Samples &samples, qint64 value);
+    static Statistics statistics(const Samples &samples);
+
+    QAtomicInt enabled;
+    QElapsedTimer timer;
+    int windowSize;
+
+    mutable QMutex mutex;
+    QMap<TraceKey, Trace> traces;
+    QQueue<TraceKey> traceOrder;
+    Samples stageSamples[StageCount];
+    Samples totalSamples[StageCount];
+};
+
+#endif // LATENCYTRACER_H
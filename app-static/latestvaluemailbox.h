@@ -0,0 +1,98 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LATESTVALUEMAILBOX_H
+#define LATESTVALUEMAILBOX_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+
+
+// Passes the latest of a series of values (e.g. snapshots of the
+// document) from any number of producers to a single consumer thread.
+// The mailbox has only one slot: posting replaces the value that wasn't
+// taken yet and frees it immediately. Producers swap the slot atomically
+// and only lock the mutex to wake up a consumer that waits for a value.
+// The slot and the waiting flag are only accessed with sequentially
+// consistent operations: a producer either sees the waiting consumer or
+// the consumer sees the posted value, so no wakeup gets lost.
+template <typename T>
+class LatestValueMailbox
+{
+public:
+    LatestValueMailbox() :
+        slot(0),
+        waiting(0)
+    {
+    }
+
+    ~LatestValueMailbox()
+    {
+        delete slot.fetchAndStoreOrdered(0);
+    }
+
+    void post(const T &value)
+    {
+        delete slot.fetchAndStoreOrdered(new Entry(value));
+
+        // QAtomicInt has no sequentially consistent load
+        if (waiting.fetchAndAddOrdered(0)) {
+            QMutexLocker locker(&mutex);
+            valuePosted.wakeOne();
+        }
+    }
+
+    // blocks until a value was posted
+    T take()
+    {
+        Entry *entry = slot.fetchAndStoreOrdered(0);
+        if (!entry) {
+            QMutexLocker locker(&mutex);
+            waiting.fetchAndStoreOrdered(1);
+            while (!(entry = slot.fetchAndStoreOrdered(0))) {
+                valuePosted.wait(&mutex);
+            }
+            waiting.fetchAndStoreOrdered(0);
+        }
+
+        T value = entry->value;
+        delete entry;
+        return value;
+    }
+
+    // true if no value was posted since the last take()
+    bool isEmpty() const
+    {
+        return slot.loadAcquire() == 0;
+    }
+
+private:
+    Q_DISABLE_COPY(LatestValueMailbox)
+
+    struct Entry
+    {
+        explicit Entry(const T &value) : value(value) {}
+        T value;
+    };
+
+    QAtomicPointer<Entry> slot;
+    QAtomicInt waiting;
+    QMutex mutex;
+    QWaitCondition valuePosted;
+};
+
+#endif // LATESTVALUEMAILBOX_H
@@ -28,7 +28,8 @@
 RevealViewSynchronizer::RevealViewSynchronizer(QWebView *webView, QPlainTextEdit *editor) :
     ViewSynchronizer(webView, editor),
     currentSlide(qMakePair(0, 0)),
-    slideLineMapping(new SlideLineMapping())
+    slideLineMapping(new SlideLineMapping()),
+    documentRevision(editor->document()->revision())
 {
     connect(webView, SIGNAL(loadFinished(bool)),
             this, SLOT(registerEvents()));
@@ -37,10 +38,10 @@ RevealViewSynchronizer::RevealViewSynchronizer(QWebView *webView, QPlainTextEdit
 
     connect(editor, SIGNAL(cursorPositionChanged()),
             this, SLOT(cursorPositionChanged()));
-    connect(editor, SIGNAL(textChanged()),
-            this, SLOT(textChanged()));
+    connect(editor->document(), SIGNAL(contentsChange(int,int,int)),
+            this, SLOT(contentsChange(int,int,int)));
 
-    textChanged();
+    slideLineMapping->build(editor->toPlainText());
 }
 
 RevealViewSynchronizer::~RevealViewSynchronizer()
@@ -109,10 +110,30 @@ void RevealViewSynchronizer::cursorPositionChanged()
     }
 }
 
-void RevealViewSynchronizer::textChanged()
+void RevealViewSynchronizer::contentsChange(int position, int charsRemoved, int charsAdded)
 {
-    QString code = m_editor->toPlainText();
-    slideLineMapping->build(code);
+    Q_UNUSED(charsRemoved)
+
+    QTextDocument *document = m_editor->document();
+
+    // ignore format changes (e.g. by the syntax highlighter)
+    if (document->revision() == documentRevision) {
+        return;
+    }
+    documentRevision = document->revision();
+
+    // only rescan the changed lines
+    int firstLine = document->findBlock(position).blockNumber();
+    int lastLine = document->findBlock(position + charsAdded).blockNumber();
+    if (firstLine < 0) {
+        firstLine = document->blockCount() - 1;
+    }
+    if (lastLine < 0) {
+        lastLine = document->blockCount() - 1;
+    }
+
+    slideLineMapping->update(firstLine, lastLine, document->blockCount(),
+                             [document](int index) { return document->findBlockByNumber(index).text(); });
 }
 
 void RevealViewSynchronizer::gotoLine(int lineNumber)
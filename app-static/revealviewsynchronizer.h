@@ -48,7 +48,7 @@ private slots:
     void registerEvents();
     void restoreSlidePosition();
     void cursorPositionChanged();
-    void textChanged();
+    void contentsChange(int position, int charsRemoved, int charsAdded);
 
 private:
     void gotoLine(int lineNumber);
@@ -57,6 +57,7 @@ private:
 private:
     QPair<int, int> currentSlide;
     SlideLineMapping *slideLineMapping;
+    int documentRevision;
 };
 
 #endif // REVEALVIEWSYNCHRONIZER_H
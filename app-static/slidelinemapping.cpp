@@ -18,41 +18,98 @@
 #include "slidelinemapping.h"
 
 #include <QRegularExpression>
+#include <QStringList>
 
-void SlideLineMapping::build(const QString &code)
+#include <algorithm>
+
+SlideLineMapping::SlideLineMapping() :
+    m_lineCount(0)
+{
+    updateSlides();
+}
+
+QStringList SlideLineMapping::splitLines(const QString &code)
 {
     static const QRegularExpression re("\n|\r\n|\r");
+    return code.split(re);
+}
+
+void SlideLineMapping::build(const QString &code)
+{
+    QStringList lines = splitLines(code);
+    update(0, lines.count() - 1, lines.count(), [&lines](int index) { return lines.at(index); });
+}
 
-    m_lineToSlide.clear();
-    m_slideToLine.clear();
-    int horizontal = 0;
-    int vertical = 0;
-    int lineNumber = 0;
-
-    QStringList lines = code.split(re);
-    m_slideToLine.insert(qMakePair(horizontal, vertical), lineNumber+1);
-    for (int i = 0; i < lines.count(); ++i) {
-        ++lineNumber;
-        if (isHorizontalSlideSeparator(lines, i)) {
-            m_lineToSlide.insert(lineNumber, qMakePair(horizontal, vertical));
-            horizontal++;
-            vertical = 0;
-            m_slideToLine.insert(qMakePair(horizontal, vertical), lineNumber+1);
+void SlideLineMapping::update(int firstLine, int lastLine, int lineCount, const LineReader &line)
+{
+    // lines [firstLine, lastLine] of the current text replace the
+    // lines [firstLine, lastLine - delta] of the previous text
+    const int delta = lineCount - m_lineCount;
+
+    // separators depend on their neighbors, so also
+    // rescan the lines around the changed lines
+    const int firstRescanned = qMax(0, firstLine - 1);
+    const int lastRescanned = qMin(lineCount - 1, lastLine + 1);
+    const int lastRescannedBefore = lastLine - delta + 1;
+
+    QVector<int> lines;
+    QVector<SeparatorType> types;
+    lines.reserve(m_separatorLines.count() + 1);
+    types.reserve(m_separatorLines.count() + 1);
+
+    // keep separators in front of the changed lines
+    int i = 0;
+    for (; i < m_separatorLines.count() && m_separatorLines.at(i) < firstRescanned; ++i) {
+        lines.append(m_separatorLines.at(i));
+        types.append(m_separatorTypes.at(i));
+    }
+
+    // skip separators of the changed lines
+    for (; i < m_separatorLines.count() && m_separatorLines.at(i) <= lastRescannedBefore; ++i) {
+    }
+
+    for (int index = firstRescanned; index <= lastRescanned; ++index) {
+        SeparatorType type = separatorType(index, lineCount, line);
+        if (type != NoSeparator) {
+            lines.append(index);
+            types.append(type);
         }
-        if (isVerticalSlideSeparator(lines, i)) {
-            m_lineToSlide.insert(lineNumber, qMakePair(horizontal, vertical));
-            vertical++;
-            m_slideToLine.insert(qMakePair(horizontal, vertical), lineNumber+1);
+    }
+
+    // shift separators behind the changed lines
+    for (; i < m_separatorLines.count(); ++i) {
+        int index = m_separatorLines.at(i) + delta;
+
+        // the first two lines can't be separators
+        if (index > 1) {
+            lines.append(index);
+            types.append(m_separatorTypes.at(i));
         }
     }
-    m_lineToSlide.insert(lineNumber, qMakePair(horizontal, vertical));
+
+    m_separatorLines = lines;
+    m_separatorTypes = types;
+    m_lineCount = lineCount;
+
+    updateSlides();
+}
+
+QVector<QPair<int, int> > SlideLineMapping::slides() const
+{
+    return m_slides;
+}
+
+QVector<int> SlideLineMapping::separatorLines() const
+{
+    return m_separatorLines;
 }
 
 int SlideLineMapping::lineForSlide(const QPair<int, int>& slide) const
 {
-    QMap<QPair<int, int>, int>::const_iterator it = m_slideToLine.find(slide);
-    if (it != m_slideToLine.end()) {
-        return it.value();
+    QVector<QPair<int, int> >::const_iterator it = std::lower_bound(m_slides.constBegin(), m_slides.constEnd(), slide);
+    if (it != m_slides.constEnd() && *it == slide) {
+        int index = it - m_slides.constBegin();
+        return index > 0 ? m_separatorLines.at(index - 1) + 2 : 1;
     }
 
     return -1;
@@ -60,42 +117,65 @@ int SlideLineMapping::lineForSlide(const QPair<int, int>& slide) const
 
 QPair<int, int> SlideLineMapping::slideForLine(int lineNumber) const
 {
-    QMap<int, QPair<int, int> >::const_iterator it = m_lineToSlide.lowerBound(lineNumber);
-    if (it != m_lineToSlide.end()) {
-        return it.value();
+    if (lineNumber > qMax(1, m_lineCount)) {
+        return qMakePair(-1, -1);
     }
 
-    return qMakePair(-1, -1);
+    // a separator line still belongs to the previous slide
+    int index = std::lower_bound(m_separatorLines.constBegin(), m_separatorLines.constEnd(), lineNumber - 1) - m_separatorLines.constBegin();
+    return m_slides.at(index);
 }
 
 QMap<int, QPair<int, int> > SlideLineMapping::lineToSlide() const
 {
-    return m_lineToSlide;
+    QMap<int, QPair<int, int> > lineToSlide;
+    for (int i = 0; i < m_separatorLines.count(); ++i) {
+        lineToSlide.insert(m_separatorLines.at(i) + 1, m_slides.at(i));
+    }
+    lineToSlide.insert(qMax(1, m_lineCount), m_slides.last());
+    return lineToSlide;
 }
 
 QMap<QPair<int, int>, int> SlideLineMapping::slideToLine() const
 {
-    return m_slideToLine;
+    QMap<QPair<int, int>, int> slideToLine;
+    for (int i = 0; i < m_slides.count(); ++i) {
+        slideToLine.insert(m_slides.at(i), lineForSlide(m_slides.at(i)));
+    }
+    return slideToLine;
 }
 
-bool SlideLineMapping::isHorizontalSlideSeparator(const QStringList &lines, int lineNumber) const
+SlideLineMapping::SeparatorType SlideLineMapping::separatorType(int index, int lineCount, const LineReader &line) const
 {
     static const QString horizontalMarker("---");
+    static const QString verticalMarker("--");
+
+    if (index <= 1 || index >= lineCount - 1) {
+        return NoSeparator;
+    }
+
+    QString text = line(index);
+    if (text != horizontalMarker && text != verticalMarker) {
+        return NoSeparator;
+    }
+
+    if (!line(index - 1).isEmpty() || !line(index + 1).isEmpty()) {
+        return NoSeparator;
+    }
 
-    return lineNumber > 1 &&
-           lineNumber < lines.count()-1 &&
-           lines[lineNumber-1].isEmpty() &&
-           lines[lineNumber] == horizontalMarker &&
-           lines[lineNumber+1].isEmpty();
+    return text == horizontalMarker ? HorizontalSeparator : VerticalSeparator;
 }
 
-bool SlideLineMapping::isVerticalSlideSeparator(const QStringList &lines, int lineNumber) const
+void SlideLineMapping::updateSlides()
 {
-    static const QString verticalMarker("--");
+    // only depends on the number of separators, not on the length of the document
+    m_slides.resize(m_separatorTypes.count() + 1);
+    m_slides[0] = qMakePair(0, 0);
 
-    return lineNumber > 1 &&
-           lineNumber < lines.count()-1 &&
-           lines[lineNumber-1].isEmpty() &&
-           lines[lineNumber] == verticalMarker &&
-           lines[lineNumber+1].isEmpty();
+    for (int i = 0; i < m_separatorTypes.count(); ++i) {
+        const QPair<int, int> &previous = m_slides.at(i);
+        m_slides[i + 1] = m_separatorTypes.at(i) == HorizontalSeparator ?
+                              qMakePair(previous.first + 1, 0)
+                            : qMakePair(previous.first, previous.second + 1);
+    }
 }
@@ -20,12 +20,26 @@
 
 #include <QMap>
 #include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
 
 
 class SlideLineMapping
 {
 public:
+    typedef std::function<QString (int)> LineReader;
+
+    SlideLineMapping();
+
+    static QStringList splitLines(const QString &code);
+
     void build(const QString &code);
+    void update(int firstLine, int lastLine, int lineCount, const LineReader &line);
+
+    QVector<QPair<int, int> > slides() const;
+    QVector<int> separatorLines() const;
 
     int lineForSlide(const QPair<int, int>& slide) const;
     QPair<int, int> slideForLine(int lineNumber) const;
@@ -34,11 +48,23 @@ public:
     QMap<QPair<int, int>, int> slideToLine() const;
 
 private:
-    bool isHorizontalSlideSeparator(const QStringList &lines, int lineNumber) const;
-    bool isVerticalSlideSeparator(const QStringList &lines, int lineNumber) const;
+    enum SeparatorType {
+        NoSeparator,
+        HorizontalSeparator,
+        VerticalSeparator
+    };
+
+    SeparatorType separatorType(int index, int lineCount, const LineReader &line) const;
+    void updateSlides();
+
+    // sorted line indexes of the separators and their types
+    QVector<int> m_separatorLines;
+    QVector<SeparatorType> m_separatorTypes;
+
+    // the slide following each separator (slide 0 starts the document)
+    QVector<QPair<int, int> > m_slides;
 
-    QMap<int, QPair<int, int> > m_lineToSlide;
-    QMap<QPair<int, int>, int> m_slideToLine;
+    int m_lineCount;
 };
 
 #endif // SLIDELINEMAPPING_H
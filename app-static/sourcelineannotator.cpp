@@ -0,0 +1,51 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sourcelineannotator.h"
+
+#include <QStringList>
+
+#include "markdownblockscanner.h"
+
+QString SourceLineAnnotator::annotate(const QString &text, int firstLineNumber)
+{
+    const QStringList lines = text.split(QLatin1Char('\n'));
+
+    QString result;
+    result.reserve(text.length() + text.length() / 4);
+
+    MarkdownBlockScanner scanner;
+
+    for (int i = 0; i < lines.count(); ++i) {
+        const QString &line = lines.at(i);
+        const QStringRef lineRef(&line);
+
+        // a new block starts after a blank line, but anchors must not be
+        // inserted in code or HTML blocks, between items of a list or
+        // between block quotes that are merged into one
+        if (scanner.isBlockStart(lineRef) && !MarkdownBlockScanner::isListItem(lineRef)) {
+            result += QStringLiteral("<div data-source-line=\"%1\"></div>\n\n").arg(i + firstLineNumber);
+        }
+        scanner.addLine(lineRef);
+
+        result += line;
+        if (i < lines.count() - 1) {
+            result += QLatin1Char('\n');
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "stallwatchdog.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTimer>
+
+#include "tracerecorder.h"
+
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define STALLWATCHDOG_BACKTRACE
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#endif
+
+static const int MAXIMUM_SCOPE_DEPTH = 32;
+static const int MAXIMUM_STALLS = 100;
+
+// the scopes of the watched thread, written by that thread only
+static QAtomicPointer<const char> scopeNames[MAXIMUM_SCOPE_DEPTH];
+static QAtomicInt scopeDepth;
+static thread_local bool watchedThread = false;
+
+QAtomicInt StallWatchdog::scopeTracking;
+
+#ifdef STALLWATCHDOG_BACKTRACE
+// the watched thread writes its own backtrace in a signal handler
+static const int BACKTRACE_SIGNAL = SIGUSR2;
+static const int MAXIMUM_FRAMES = 64;
+static void *backtraceFrames[MAXIMUM_FRAMES];
+static QAtomicInt backtraceDepth(-1);
+static pthread_t watchedThreadHandle;
+
+static void backtraceSignalHandler(int)
+{
+    backtraceDepth.storeRelease(backtrace(backtraceFrames, MAXIMUM_FRAMES));
+}
+#endif
+
+
+StallWatchdog::StallWatchdog(QObject *parent) :
+    QThread(parent),
+    heartbeatTimer(0),
+    threshold(0),
+    backtraceEnabled(false),
+    lastHeartbeat(0),
+    documentSize(0),
+    documentRevision(0),
+    stopRequested(false)
+{
+    setObjectName(QStringLiteral("StallWatchdog"));
+    timer.start();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stopWatching();
+}
+
+StallWatchdog *StallWatchdog::instance()
+{
+    static StallWatchdog watchdog;
+    return &watchdog;
+}
+
+void StallWatchdog::setBacktraceEnabled(bool enabled)
+{
+    backtraceEnabled = enabled;
+}
+
+void StallWatchdog::startWatching(int threshold)
+{
+    if (isRunning()) {
+        return;
+    }
+
+    this->threshold = threshold;
+    stopRequested = false;
+
+    // the calling thread is the one to watch
+    watchedThread = true;
+    scopeDepth.store(0);
+    scopeTracking.store(1);
+
+#ifdef STALLWATCHDOG_BACKTRACE
+    if (backtraceEnabled) {
+        watchedThreadHandle = pthread_self();
+
+        struct sigaction action;
+        action.sa_handler = backtraceSignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(BACKTRACE_SIGNAL, &action, 0);
+
+        // the first call of backtrace() loads libgcc, which
+        // is not safe inside of a signal handler
+        backtrace(backtraceFrames, MAXIMUM_FRAMES);
+    }
+#endif
+
+    // without an event loop the heartbeats have to be sent manually
+    if (QCoreApplication::instance()) {
+        heartbeatTimer = new QTimer;
+        heartbeatTimer->setInterval(qBound(10, threshold / 4, 250));
+        connect(heartbeatTimer, SIGNAL(timeout()), this, SLOT(heartbeat()));
+        heartbeatTimer->start();
+    }
+
+    heartbeat();
+    start();
+}
+
+void StallWatchdog::stopWatching()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        wakeUp.wakeAll();
+    }
+    wait();
+
+    delete heartbeatTimer;
+    heartbeatTimer = 0;
+
+    scopeTracking.store(0);
+    watchedThread = false;
+}
+
+bool StallWatchdog::isWatching() const
+{
+    return isRunning();
+}
+
+void StallWatchdog::setDocumentState(int size, int revision)
+{
+    documentSize.store(size);
+    documentRevision.store(revision);
+}
+
+QList<StallWatchdog::Stall> StallWatchdog::stalls() const
+{
+    QMutexLocker locker(&mutex);
+    return recordedStalls;
+}
+
+void StallWatchdog::heartbeat()
+{
+    lastHeartbeat.storeRelease(timer.elapsed());
+}
+
+void StallWatchdog::run()
+{
+    const int interval = qBound(10, threshold / 4, 250);
+
+    bool stalled = false;
+    qint64 stallBegin = 0;
+    Stall stall;
+
+    forever {
+        {
+            QMutexLocker locker(&mutex);
+            if (!stopRequested) {
+                wakeUp.wait(&mutex, interval);
+            }
+            if (stopRequested) {
+                return;
+            }
+        }
+
+        const qint64 heartbeat = lastHeartbeat.loadAcquire();
+
+        if (!stalled && timer.elapsed() - heartbeat > threshold) {
+            // capture the culprit while the thread is still blocked
+            stalled = true;
+            stallBegin = heartbeat;
+            stall = captureStall();
+        } else if (stalled && heartbeat != stallBegin) {
+            // the duration is accurate to the heartbeat interval
+            stalled = false;
+            stall.duration = heartbeat - stallBegin;
+            report(stall);
+        }
+    }
+}
+
+bool StallWatchdog::pushScope(const char *name)
+{
+    if (!watchedThread) {
+        return false;
+    }
+
+    const int depth = scopeDepth.load();
+    if (depth < MAXIMUM_SCOPE_DEPTH) {
+        scopeNames[depth].store(name);
+    }
+    scopeDepth.storeRelease(depth + 1);
+
+    return true;
+}
+
+void StallWatchdog::popScope()
+{
+    const int depth = scopeDepth.load();
+    if (depth > 0) {
+        scopeDepth.storeRelease(depth - 1);
+    }
+}
+
+QStringList StallWatchdog::currentScopes()
+{
+    QStringList scopes;
+
+    const int depth = qMin(scopeDepth.loadAcquire(), MAXIMUM_SCOPE_DEPTH);
+    for (int i = 0; i < depth; ++i) {
+        scopes << QString::fromLatin1(scopeNames[i].load());
+    }
+
+    return scopes;
+}
+
+StallWatchdog::Stall StallWatchdog::captureStall() const
+{
+    Stall stall;
+    stall.duration = 0;
+    stall.scopes = currentScopes();
+    stall.documentSize = documentSize.load();
+    stall.revision = documentRevision.load();
+
+    if (backtraceEnabled) {
+        stall.backtrace = captureBacktrace();
+    }
+
+    return stall;
+}
+
+QStringList StallWatchdog::captureBacktrace() const
+{
+    QStringList frames;
+
+#ifdef STALLWATCHDOG_BACKTRACE
+    backtraceDepth.store(-1);
+    if (pthread_kill(watchedThreadHandle, BACKTRACE_SIGNAL) != 0) {
+        return frames;
+    }
+
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    while (backtraceDepth.loadAcquire() < 0 && waitTimer.elapsed() < 100) {
+        usleep(100);
+    }
+
+    const int depth = backtraceDepth.loadAcquire();
+    if (depth <= 0) {
+        return frames;
+    }
+
+    char **symbols = backtrace_symbols(backtraceFrames, depth);
+    if (symbols) {
+        // skip the signal handler and the signal trampoline
+        for (int i = 2; i < depth; ++i) {
+            frames << QString::fromLocal8Bit(symbols[i]);
+        }
+        free(symbols);
+    }
+#endif
+
+    return frames;
+}
+
+void StallWatchdog::report(const Stall &stall)
+{
+    const QString culprit = stall.scopes.isEmpty()
+                          ? QStringLiteral("an uninstrumented scope")
+                          : stall.scopes.join(QStringLiteral(" > "));
+
+    qWarning().noquote() << QStringLiteral("stall: event loop blocked for %1 ms in %2 (document: %3 characters, revision %4)")
+                            .arg(stall.duration)
+                            .arg(culprit)
+                            .arg(stall.documentSize)
+                            .arg(stall.revision);
+    foreach (const QString &frame, stall.backtrace) {
+        qWarning().noquote() << "    " + frame;
+    }
+
+    // show the stall next to the activity of the worker threads
+    TraceRecorder *recorder = TraceRecorder::instance();
+    if (recorder->isEnabled()) {
+        const qint64 end = recorder->timestamp();
+        recorder->record("StallWatchdog::stall", "watchdog", end - stall.duration * 1000, end);
+    }
+
+    QMutexLocker locker(&mutex);
+    if (recordedStalls.count() == MAXIMUM_STALLS) {
+        recordedStalls.removeFirst();
+    }
+    recordedStalls.append(stall);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+class QTimer;
+
+
+// Detects stalls of the event loop of the watched (GUI) thread. The
+// event loop sends heartbeats, if none arrives within the threshold the
+// watchdog records the instrumented scopes (see TraceSpan) the thread is
+// executing and optionally a backtrace. Stalls are logged together with
+// the size and revision of the current document.
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    // durations in milliseconds, scopes from outermost to innermost
+    struct Stall
+    {
+        qint64 duration;
+        QStringList scopes;
+        QStringList backtrace;
+        int documentSize;
+        int revision;
+    };
+
+    explicit StallWatchdog(QObject *parent = 0);
+    ~StallWatchdog();
+
+    static StallWatchdog *instance();
+
+    void setBacktraceEnabled(bool enabled);
+
+    void startWatching(int threshold);
+    void stopWatching();
+    bool isWatching() const;
+
+    void setDocumentState(int size, int revision);
+
+    QList<Stall> stalls() const;
+
+    // only tracked for the watched thread, returns true if the scope was entered
+    static bool enterScope(const char *name) { return scopeTracking.load() && pushScope(name); }
+    static void leaveScope() { popScope(); }
+
+public slots:
+    void heartbeat();
+
+protected:
+    virtual void run();
+
+private:
+    static bool pushScope(const char *name);
+    static void popScope();
+    static QStringList currentScopes();
+
+    Stall captureStall() const;
+    QStringList captureBacktrace() const;
+    void report(const Stall &stall);
+
+    static QAtomicInt scopeTracking;
+
+    QElapsedTimer timer;
+    QTimer *heartbeatTimer;
+    int threshold;
+    bool backtraceEnabled;
+    QAtomicInteger<qint64> lastHeartbeat;
+    QAtomicInt documentSize;
+    QAtomicInt documentRevision;
+
+    mutable QMutex mutex;
+    QWaitCondition wakeUp;
+    bool stopRequested;
+    QList<Stall> recordedStalls;
+};
+
+#endif // STALLWATCHDOG_H
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "highlightjssupport.h"
+
+#include <QFile>
+#include <QRegularExpression>
+
+#include <fragmentcache.h>
+
+// highlight all code blocks not taken from the cache and store the
+// result keyed by the language and the code of the block
+static const QString HIGHLIGHT_SCRIPT = QStringLiteral(
+    "<script>document.addEventListener('DOMContentLoaded', function() {"
+    "  var blocks = document.querySelectorAll('pre code');"
+    "  for (var i = 0; i < blocks.length; i++) {"
+    "    var block = blocks[i];"
+    "    if (block.classList.contains('hljs')) continue;"
+    "    var source = block.className + '\\n' + block.textContent;"
+    "    hljs.highlightBlock(block);"
+    "    if (typeof fragmentCache !== 'undefined') fragmentCache.insert('code-%1', source, block.innerHTML);"
+    "  }"
+    "});</script>\n");
+
+
+QString HighlightJsSupport::buildHtmlHeader(const QString &style, bool loadScript)
+{
+    QString header = QString("<link rel=\"stylesheet\" href=\"qrc:/scripts/highlight.js/styles/%1.css\">\n").arg(style);
+
+    if (loadScript) {
+        header += "<script src=\"qrc:/scripts/highlight.js/highlight.pack.js\"></script>\n";
+        header += HIGHLIGHT_SCRIPT.arg(style);
+    }
+
+    return header;
+}
+
+QString HighlightJsSupport::buildExportHeader(const QString &styleSheet, const QString &script, const QString &style)
+{
+    QString header;
+    if (!styleSheet.isEmpty()) {
+        header += QString("\n<style>%1</style>").arg(styleSheet);
+    }
+
+    // exported files embed the script and its style
+    if (!script.isEmpty()) {
+        QString highlightStyle;
+        QFile f(QString(":/scripts/highlight.js/styles/%1.css").arg(style));
+        if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            highlightStyle = f.readAll();
+        }
+
+        header += QString("\n<style>%1</style>").arg(highlightStyle);
+        header += QString("\n<script>%1</script>").arg(script);
+        header += "\n<script>hljs.initHighlightingOnLoad();</script>";
+    }
+
+    return header;
+}
+
+bool HighlightJsSupport::replaceHighlightedCode(QString &body, const QString &style)
+{
+    static const QRegularExpression rx(QStringLiteral("<pre><code(?: class=\"([^\"]*)\")?>(.*?)</code></pre>"),
+                                       QRegularExpression::DotMatchesEverythingOption);
+
+    const QString kind = QStringLiteral("code-") + style;
+    FragmentCache *cache = FragmentCache::instance();
+
+    QString result;
+    result.reserve(body.size());
+
+    bool unhighlightedCode = false;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(body);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+
+        // diagrams are rendered by mermaid
+        const QString language = match.captured(1);
+        if (language == QLatin1String("mermaid")) {
+            continue;
+        }
+
+        const QString source = language + QLatin1Char('\n') + FragmentCache::textFromHtml(match.captured(2));
+        const QString fragment = cache->find(kind, source);
+        if (fragment.isEmpty()) {
+            unhighlightedCode = true;
+            continue;
+        }
+
+        result += body.midRef(pos, match.capturedStart() - pos);
+        result += QStringLiteral("<pre><code class=\"") + (language + QStringLiteral(" hljs")).trimmed()
+                + QStringLiteral("\">") + fragment + QStringLiteral("</code></pre>");
+        pos = match.capturedEnd();
+    }
+
+    result += body.midRef(pos);
+    body = result;
+
+    return unhighlightedCode;
+}
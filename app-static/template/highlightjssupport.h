@@ -0,0 +1,33 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HIGHLIGHTJSSUPPORT_H
+#define HIGHLIGHTJSSUPPORT_H
+
+#include <QString>
+
+
+// Builds the highlight.js header of the templates and replaces code
+// blocks which were already highlighted with the cached output.
+class HighlightJsSupport
+{
+public:
+    static QString buildHtmlHeader(const QString &style, bool loadScript);
+    static QString buildExportHeader(const QString &styleSheet, const QString &script, const QString &style);
+    static bool replaceHighlightedCode(QString &body, const QString &style);
+};
+
+#endif // HIGHLIGHTJSSUPPORT_H
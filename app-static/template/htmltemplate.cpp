@@ -34,6 +34,10 @@
 #include <QFile>
 #include <QRegularExpression>
 
+#include "highlightjssupport.h"
+#include "mathjaxsupport.h"
+#include "mermaidsupport.h"
+
 HtmlTemplate::HtmlTemplate()
 {
     QFile f(":/template.html");
@@ -60,7 +64,31 @@ QString HtmlTemplate::render(const QString &body, RenderOptions options) const
         convertDiagramCodeSectionToDiv(htmlBody);
     }
 
-    return renderAsHtml(QString(), htmlBody, options);
+    // formulas typeset before are taken from the cache and
+    // MathJax is only loaded if there are new formulas
+    MathJaxSupport::ScriptSource mathScript = MathJaxSupport::NoScript;
+    if (options.testFlag(Template::MathSupport)) {
+        // a '$' in a diagram doesn't start a formula
+        const QStringList diagrams = MermaidSupport::extractDiagrams(htmlBody);
+        if (MathJaxSupport::replaceTypesetMath(htmlBody, options)) {
+            mathScript = MathJaxSupport::LocalScript;
+        }
+        MermaidSupport::restoreDiagrams(htmlBody, diagrams);
+    }
+
+    // code blocks highlighted before are taken from the cache
+    bool highlightingScript = false;
+    if (options.testFlag(Template::CodeHighlighting)) {
+        highlightingScript = HighlightJsSupport::replaceHighlightedCode(htmlBody, codeHighlightingStyle());
+    }
+
+    // diagrams rendered before are taken from the cache
+    bool diagramScript = false;
+    if (options.testFlag(Template::DiagramSupport)) {
+        diagramScript = MermaidSupport::replaceRenderedDiagrams(htmlBody);
+    }
+
+    return renderAsHtml(QString(), htmlBody, options, mathScript, highlightingScript, diagramScript);
 }
 
 QString HtmlTemplate::exportAsHtml(const QString &header, const QString &body, RenderOptions options) const
@@ -68,16 +96,33 @@ QString HtmlTemplate::exportAsHtml(const QString &header, const QString &body, R
     // clear code highlighting option since it depends on the resource file
     options &= ~Template::CodeHighlighting;
 
-    return renderAsHtml(header, body, options);
+    // exported files can't rely on a local MathJax installation
+    QString htmlBody(body);
+    MathJaxSupport::ScriptSource mathScript = MathJaxSupport::NoScript;
+    if (options.testFlag(Template::MathSupport)) {
+        const QStringList diagrams = MermaidSupport::extractDiagrams(htmlBody);
+        if (MathJaxSupport::replaceTypesetMath(htmlBody, options)) {
+            mathScript = MathJaxSupport::OnlineScript;
+        }
+        MermaidSupport::restoreDiagrams(htmlBody, diagrams);
+    }
+
+    // embed the diagrams already rendered in the preview
+    bool diagramScript = false;
+    if (options.testFlag(Template::DiagramSupport)) {
+        diagramScript = MermaidSupport::replaceRenderedDiagrams(htmlBody);
+    }
+
+    return renderAsHtml(header, htmlBody, options, mathScript, false, diagramScript);
 }
 
-QString HtmlTemplate::renderAsHtml(const QString &header, const QString &body, Template::RenderOptions options) const
+QString HtmlTemplate::renderAsHtml(const QString &header, const QString &body, Template::RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript, bool diagramScript) const
 {
     if (htmlTemplate.isEmpty()) {
         return body;
     }
 
-    QString htmlHeader = buildHtmlHeader(options);
+    QString htmlHeader = buildHtmlHeader(options, mathScript, highlightingScript, diagramScript);
     htmlHeader += header;
 
     return QString(htmlTemplate)
@@ -85,7 +130,7 @@ QString HtmlTemplate::renderAsHtml(const QString &header, const QString &body, T
             .replace(QLatin1String("<!--__HTML_CONTENT__-->"), body);
 }
 
-QString HtmlTemplate::buildHtmlHeader(RenderOptions options) const
+QString HtmlTemplate::buildHtmlHeader(RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript, bool diagramScript) const
 {
     QString header;
 
@@ -95,27 +140,16 @@ QString HtmlTemplate::buildHtmlHeader(RenderOptions options) const
     }
 
     // add MathJax.js script to HTML header
-    if (options.testFlag(Template::MathSupport)) {
-
-        // Add MathJax support for inline LaTeX Math
-        if (options.testFlag(Template::MathInlineSupport)) {
-            header += "<script type=\"text/x-mathjax-config\">MathJax.Hub.Config({tex2jax: {inlineMath: [['$','$'], ['\\\\(','\\\\)']]}});</script>";
-        }
-
-        header += "<script type=\"text/javascript\" src=\"http://cdn.mathjax.org/mathjax/latest/MathJax.js?config=TeX-AMS-MML_HTMLorMML\"></script>\n";
-    }
+    header += MathJaxSupport::buildHtmlHeader(options, mathScript);
 
     // add Highlight.js script to HTML header
     if (options.testFlag(Template::CodeHighlighting)) {
-        header += QString("<link rel=\"stylesheet\" href=\"qrc:/scripts/highlight.js/styles/%1.css\">\n").arg(codeHighlightingStyle());
-        header += "<script src=\"qrc:/scripts/highlight.js/highlight.pack.js\"></script>\n";
-        header += "<script>hljs.initHighlightingOnLoad();</script>\n";
+        header += HighlightJsSupport::buildHtmlHeader(codeHighlightingStyle(), highlightingScript);
     }
 
     // add mermaid.js script to HTML header
     if (options.testFlag(Template::DiagramSupport)) {
-        header += "<link rel=\"stylesheet\" href=\"qrc:/scripts/mermaid/mermaid.css\">\n";
-        header += "<script src=\"qrc:/scripts/mermaid/mermaid.full.min.js\"></script>\n";
+        header += MermaidSupport::buildHtmlHeader(diagramScript);
     }
 
     return header;
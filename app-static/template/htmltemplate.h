@@ -33,6 +33,7 @@
 #define HTMLTEMPLATE_H
 
 #include "template.h"
+#include "mathjaxsupport.h"
 
 class HtmlTemplate : public Template
 {
@@ -44,8 +45,8 @@ public:
     virtual QString exportAsHtml(const QString &header, const QString &body, RenderOptions options) const;
 
 private:
-    QString renderAsHtml(const QString &header, const QString &body, RenderOptions options) const;
-    QString buildHtmlHeader(RenderOptions options) const;
+    QString renderAsHtml(const QString &header, const QString &body, RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript, bool diagramScript) const;
+    QString buildHtmlHeader(RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript, bool diagramScript) const;
     void convertDiagramCodeSectionToDiv(QString &body) const;
 
     QString htmlTemplate;
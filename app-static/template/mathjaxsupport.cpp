@@ -0,0 +1,224 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mathjaxsupport.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QUrl>
+
+#include <fragmentcache.h>
+
+static const QString MATHJAX_CONFIG = QStringLiteral("?config=TeX-AMS-MML_SVG");
+static const QString MATHJAX_ONLINE_URL = QStringLiteral("http://cdn.mathjax.org/mathjax/latest/MathJax.js");
+
+// the SVG output is self-contained, so the cached formulas
+// are displayed correctly even without loading MathJax
+static const QString MATHJAX_STYLE = QStringLiteral(
+    "<style>"
+    ".MathJax_SVG_Display {display: block; text-align: center; margin: 1em 0;} "
+    ".MathJax_SVG {display: inline; line-height: normal; white-space: nowrap;}"
+    "</style>\n");
+
+// store the typeset formulas of the page in the fragment cache
+// after MathJax finished the typesetting
+static const QString MATHJAX_CACHE_SCRIPT = QStringLiteral(
+    "MathJax.Hub.Register.StartupHook('End', function() {"
+    "  if (typeof fragmentCache === 'undefined') return;"
+    "  var jax = MathJax.Hub.getAllJax();"
+    "  for (var i = 0; i < jax.length; i++) {"
+    "    var frame = document.getElementById(jax[i].inputID + '-Frame');"
+    "    if (!frame) continue;"
+    "    var display = frame.parentNode.className === 'MathJax_SVG_Display';"
+    "    var node = display ? frame.parentNode : frame;"
+    "    fragmentCache.insert(display ? 'math-display' : 'math-inline', jax[i].originalText,"
+    "                         node.outerHTML.replace(' id=\"' + frame.id + '\"', ''));"
+    "  }"
+    "});");
+
+namespace {
+
+struct MathDelimiter
+{
+    QString open;
+    QString close;
+    bool display;
+};
+
+}
+
+static QString findLocalMathJax()
+{
+    // MathJax bundled into the resources by the packager
+    if (QFile::exists(QStringLiteral(":/scripts/mathjax/MathJax.js"))) {
+        return QStringLiteral("qrc:/scripts/mathjax/MathJax.js");
+    }
+
+    QStringList paths;
+    paths << QCoreApplication::applicationDirPath() + QStringLiteral("/mathjax/MathJax.js")
+          << QStringLiteral("/usr/share/javascript/mathjax/MathJax.js")
+          << QStringLiteral("/usr/share/mathjax/MathJax.js");
+
+    foreach (const QString &path, paths) {
+        if (QFile::exists(path)) {
+            return QUrl::fromLocalFile(path).toString();
+        }
+    }
+
+    return QString();
+}
+
+static QString tagName(const QString &body, int pos)
+{
+    int end = pos + 1;
+    while (end < body.size() && body.at(end).isLetterOrNumber()) {
+        end++;
+    }
+    return body.mid(pos + 1, end - pos - 1).toLower();
+}
+
+QString MathJaxSupport::buildHtmlHeader(Template::RenderOptions options, ScriptSource source)
+{
+    if (!options.testFlag(Template::MathSupport)) {
+        return QString();
+    }
+
+    QString header = MATHJAX_STYLE;
+
+    if (source != NoScript) {
+        // the source of diagrams is left alone
+        QString tex2jax = QStringLiteral("ignoreClass: 'tex2jax_ignore|mermaid'");
+
+        // Add MathJax support for inline LaTeX Math
+        if (options.testFlag(Template::MathInlineSupport)) {
+            tex2jax += QStringLiteral(", inlineMath: [['$','$'], ['\\\\(','\\\\)']]");
+        }
+
+        const QString config = QStringLiteral("SVG: {useGlobalCache: false}, tex2jax: {%1}").arg(tex2jax);
+
+        header += QString("<script type=\"text/x-mathjax-config\">MathJax.Hub.Config({%1});%2</script>\n")
+                .arg(config).arg(MATHJAX_CACHE_SCRIPT);
+        header += QString("<script type=\"text/javascript\" src=\"%1\"></script>\n").arg(scriptUrl(source));
+    }
+
+    return header;
+}
+
+bool MathJaxSupport::replaceTypesetMath(QString &body, Template::RenderOptions options)
+{
+    static const QStringList skippedTags = QStringList()
+            << "pre" << "code" << "script" << "style" << "textarea" << "noscript";
+
+    // same delimiters as used by the tex2jax preprocessor
+    QList<MathDelimiter> delimiters;
+    delimiters << MathDelimiter { QStringLiteral("$$"), QStringLiteral("$$"), true }
+               << MathDelimiter { QStringLiteral("\\["), QStringLiteral("\\]"), true }
+               << MathDelimiter { QStringLiteral("\\("), QStringLiteral("\\)"), false };
+    if (options.testFlag(Template::MathInlineSupport)) {
+        delimiters << MathDelimiter { QStringLiteral("$"), QStringLiteral("$"), false };
+    }
+
+    FragmentCache *cache = FragmentCache::instance();
+
+    QString result;
+    result.reserve(body.size());
+
+    bool untypesetMath = false;
+    int pos = 0;
+    while (pos < body.size()) {
+        const QChar c = body.at(pos);
+
+        if (c == QLatin1Char('<')) {
+            int end = body.indexOf(QLatin1Char('>'), pos);
+            end = end < 0 ? body.size() : end + 1;
+
+            // MathJax doesn't process the content of these elements
+            const QString name = tagName(body, pos);
+            if (skippedTags.contains(name)) {
+                const int close = body.indexOf(QStringLiteral("</") + name, end, Qt::CaseInsensitive);
+                end = close < 0 ? body.size() : close;
+            }
+
+            result += body.midRef(pos, end - pos);
+            pos = end;
+            continue;
+        }
+
+        if (c == QLatin1Char('$') || c == QLatin1Char('\\')) {
+            bool found = false;
+            foreach (const MathDelimiter &delimiter, delimiters) {
+                if (!body.midRef(pos, delimiter.open.size()).startsWith(delimiter.open)) {
+                    continue;
+                }
+
+                const int start = pos + delimiter.open.size();
+                const int close = body.indexOf(delimiter.close, start);
+                if (close <= start) {
+                    break;
+                }
+
+                const QString source = body.mid(start, close - start);
+                const int end = close + delimiter.close.size();
+
+                // formulas spanning HTML tags are left to MathJax
+                QString fragment;
+                if (!source.contains(QLatin1Char('<'))) {
+                    const QString kind = delimiter.display ? QStringLiteral("math-display") : QStringLiteral("math-inline");
+                    fragment = cache->find(kind, FragmentCache::textFromHtml(source));
+                }
+
+                if (fragment.isEmpty()) {
+                    result += body.midRef(pos, end - pos);
+                    untypesetMath = true;
+                } else {
+                    result += fragment;
+                }
+
+                pos = end;
+                found = true;
+                break;
+            }
+
+            if (found) {
+                continue;
+            }
+        }
+
+        result += c;
+        pos++;
+    }
+
+    // environments like \begin{align} are always typeset by MathJax
+    if (result.contains(QLatin1String("\\begin{"))) {
+        untypesetMath = true;
+    }
+
+    body = result;
+    return untypesetMath;
+}
+
+QString MathJaxSupport::scriptUrl(ScriptSource source)
+{
+    if (source == LocalScript) {
+        static const QString localUrl = findLocalMathJax();
+        if (!localUrl.isEmpty()) {
+            return localUrl + MATHJAX_CONFIG;
+        }
+    }
+
+    return MATHJAX_ONLINE_URL + MATHJAX_CONFIG;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MATHJAXSUPPORT_H
+#define MATHJAXSUPPORT_H
+
+#include "template.h"
+
+
+// Builds the MathJax header of the templates and replaces formulas
+// which were already typeset by MathJax with the cached SVG output.
+class MathJaxSupport
+{
+public:
+    enum ScriptSource {
+        NoScript,
+        LocalScript,
+        OnlineScript
+    };
+
+    static QString buildHtmlHeader(Template::RenderOptions options, ScriptSource source);
+    static bool replaceTypesetMath(QString &body, Template::RenderOptions options);
+
+    static QString scriptUrl(ScriptSource source);
+};
+
+#endif // MATHJAXSUPPORT_H
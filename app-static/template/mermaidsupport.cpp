@@ -0,0 +1,134 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mermaidsupport.h"
+
+#include <QRegularExpression>
+
+#include <fragmentcache.h>
+
+// render all diagrams not taken from the cache and store the SVG output
+// keyed by the diagram source. The id of the SVG element is made unique,
+// because mermaid starts counting from zero on every page.
+static const QString MERMAID_SCRIPT = QStringLiteral(
+    "<script>document.addEventListener('DOMContentLoaded', function() {"
+    "  var diagrams = [];"
+    "  var elements = document.querySelectorAll('.mermaid');"
+    "  for (var i = 0; i < elements.length; i++) {"
+    "    if (!elements[i].getAttribute('data-processed'))"
+    "      diagrams.push({ element: elements[i], source: elements[i].textContent.trim() });"
+    "  }"
+    "  try { mermaid.init(mermaid.sequenceConfig); } catch (e) {}"
+    "  if (typeof fragmentCache === 'undefined') return;"
+    "  var prefix = 'mermaidCache' + Date.now().toString(36) + '_';"
+    "  for (var i = 0; i < diagrams.length; i++) {"
+    "    var svg = diagrams[i].element.firstChild;"
+    "    if (!svg || !svg.id || svg.childNodes.length == 0) continue;"
+    "    if (svg.childNodes.length == 1 && svg.firstChild.childNodes.length == 0) continue;"
+    "    var html = diagrams[i].element.innerHTML.split(svg.id).join(prefix + i);"
+    "    fragmentCache.insert('mermaid', diagrams[i].source, html);"
+    "  }"
+    "});</script>\n");
+
+static const QRegularExpression &diagramExpression()
+{
+    static const QRegularExpression rx(QStringLiteral("<pre><code class=\"mermaid\">(.*?)</code></pre>|<div class=\"mermaid\">(.*?)</div>"),
+                                       QRegularExpression::DotMatchesEverythingOption);
+    return rx;
+}
+
+static QString placeholder(int index)
+{
+    return QStringLiteral("<!--mermaid:%1-->").arg(index);
+}
+
+
+QString MermaidSupport::buildHtmlHeader(bool loadScript)
+{
+    QString header = "<link rel=\"stylesheet\" href=\"qrc:/scripts/mermaid/mermaid.css\">\n";
+
+    if (loadScript) {
+        // diagrams are rendered by our own script
+        header += "<script>var mermaid_config = { startOnLoad: false };</script>\n";
+        header += "<script src=\"qrc:/scripts/mermaid/mermaid.full.min.js\"></script>\n";
+        header += MERMAID_SCRIPT;
+    }
+
+    return header;
+}
+
+bool MermaidSupport::replaceRenderedDiagrams(QString &body)
+{
+    FragmentCache *cache = FragmentCache::instance();
+
+    QString result;
+    result.reserve(body.size());
+
+    bool unrenderedDiagrams = false;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = diagramExpression().globalMatch(body);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+
+        const QString code = match.capturedStart(1) >= 0 ? match.captured(1) : match.captured(2);
+        const QString fragment = cache->find(QStringLiteral("mermaid"), FragmentCache::textFromHtml(code).trimmed());
+        if (fragment.isEmpty()) {
+            unrenderedDiagrams = true;
+            continue;
+        }
+
+        // mermaid skips diagrams marked as processed
+        result += body.midRef(pos, match.capturedStart() - pos);
+        result += QStringLiteral("<div class=\"mermaid\" data-processed=\"true\">") + fragment + QStringLiteral("</div>");
+        pos = match.capturedEnd();
+    }
+
+    result += body.midRef(pos);
+    body = result;
+
+    return unrenderedDiagrams;
+}
+
+QStringList MermaidSupport::extractDiagrams(QString &body)
+{
+    QStringList diagrams;
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = diagramExpression().globalMatch(body);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+
+        result += body.midRef(pos, match.capturedStart() - pos);
+        result += placeholder(diagrams.count());
+        diagrams << match.captured();
+        pos = match.capturedEnd();
+    }
+
+    if (!diagrams.isEmpty()) {
+        result += body.midRef(pos);
+        body = result;
+    }
+
+    return diagrams;
+}
+
+void MermaidSupport::restoreDiagrams(QString &body, const QStringList &diagrams)
+{
+    for (int i = 0; i < diagrams.count(); ++i) {
+        body.replace(placeholder(i), diagrams.at(i));
+    }
+}
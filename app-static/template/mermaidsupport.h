@@ -0,0 +1,38 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MERMAIDSUPPORT_H
+#define MERMAIDSUPPORT_H
+
+#include <QString>
+#include <QStringList>
+
+
+// Builds the mermaid header of the templates and replaces diagrams
+// which were already rendered with the cached SVG output.
+class MermaidSupport
+{
+public:
+    static QString buildHtmlHeader(bool loadScript);
+    static bool replaceRenderedDiagrams(QString &body);
+
+    // replaces the diagrams by placeholders, so other replacements
+    // (e.g. of formulas) can't change the diagram source
+    static QStringList extractDiagrams(QString &body);
+    static void restoreDiagrams(QString &body, const QStringList &diagrams);
+};
+
+#endif // MERMAIDSUPPORT_H
@@ -18,6 +18,9 @@
 
 #include <QFile>
 
+#include "highlightjssupport.h"
+#include "mathjaxsupport.h"
+
 PresentationTemplate::PresentationTemplate()
 {
     QFile f(":/template_presentation.html");
@@ -28,34 +31,61 @@ PresentationTemplate::PresentationTemplate()
 
 QString PresentationTemplate::render(const QString &body, RenderOptions options) const
 {
-    if (presentationTemplate.isEmpty()) {
-        return body;
+    QString htmlBody(body);
+    MathJaxSupport::ScriptSource mathScript = MathJaxSupport::NoScript;
+    if (options.testFlag(Template::MathSupport) && MathJaxSupport::replaceTypesetMath(htmlBody, options)) {
+        mathScript = MathJaxSupport::LocalScript;
     }
 
-    return QString(presentationTemplate)
-            .replace(QLatin1String("<!--__HTML_HEADER__-->"), QString())
-            .replace(QLatin1String("<!--__HTML_CONTENT__-->"), body)
-            .replace(QLatin1String("<!--__REVEAL_PLUGINS__-->"), buildRevealPlugins(options));
+    // code blocks highlighted before are taken from the cache
+    bool highlightingScript = false;
+    if (options.testFlag(Template::CodeHighlighting)) {
+        highlightingScript = HighlightJsSupport::replaceHighlightedCode(htmlBody, codeHighlightingStyle());
+    }
+
+    return renderAsHtml(QString(), htmlBody, options, mathScript, highlightingScript);
+}
+
+QString PresentationTemplate::exportAsHtml(const QString &header, const QString &body, RenderOptions options) const
+{
+    // clear code highlighting option since it depends on the resource file
+    options &= ~Template::CodeHighlighting;
+
+    QString htmlBody(body);
+    MathJaxSupport::ScriptSource mathScript = MathJaxSupport::NoScript;
+    if (options.testFlag(Template::MathSupport) && MathJaxSupport::replaceTypesetMath(htmlBody, options)) {
+        mathScript = MathJaxSupport::OnlineScript;
+    }
+
+    return renderAsHtml(header, htmlBody, options, mathScript, false);
 }
 
-QString PresentationTemplate::exportAsHtml(const QString &, const QString &body, RenderOptions options) const
+QString PresentationTemplate::renderAsHtml(const QString &header, const QString &body, RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript) const
 {
-    return render(body, options);
+    if (presentationTemplate.isEmpty()) {
+        return body;
+    }
+
+    QString htmlHeader = buildHtmlHeader(options, mathScript, highlightingScript);
+    htmlHeader += header;
+
+    return QString(presentationTemplate)
+            .replace(QLatin1String("<!--__HTML_HEADER__-->"), htmlHeader)
+            .replace(QLatin1String("<!--__HTML_CONTENT__-->"), body);
 }
 
-QString PresentationTemplate::buildRevealPlugins(RenderOptions options) const
+QString PresentationTemplate::buildHtmlHeader(RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript) const
 {
-    QString plugins;
+    QString header;
 
-    // add MathJax.js script as reveal plugin
-    if (options.testFlag(Template::MathSupport)) {
-        plugins += "{ src: 'https://cdn.jsdelivr.net/reveal.js/2.6.2/plugin/math/math.js', async: true },\n";
-    }
+    // add MathJax.js script to HTML header
+    header += MathJaxSupport::buildHtmlHeader(options, mathScript);
 
-    // add Highlight.js script as reveal plugin
+    // slides are already HTML, so highlight.js can be used
+    // directly instead of the reveal.js highlight plugin
     if (options.testFlag(Template::CodeHighlighting)) {
-        plugins += "{ src: 'https://cdn.jsdelivr.net/reveal.js/2.6.2/plugin/highlight/highlight.js', async: true, callback: function() { hljs.initHighlightingOnLoad(); } },\n";
+        header += HighlightJsSupport::buildHtmlHeader(codeHighlightingStyle(), highlightingScript);
     }
 
-    return plugins;
+    return header;
 }
@@ -18,6 +18,7 @@
 #define PRESENTATIONTEMPLATE_H
 
 #include "template.h"
+#include "mathjaxsupport.h"
 
 class PresentationTemplate : public Template
 {
@@ -28,7 +29,8 @@ public:
     virtual QString exportAsHtml(const QString &header, const QString &body, RenderOptions options) const;
 
 private:
-    QString buildRevealPlugins(RenderOptions options) const;
+    QString renderAsHtml(const QString &header, const QString &body, RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript) const;
+    QString buildHtmlHeader(RenderOptions options, MathJaxSupport::ScriptSource mathScript, bool highlightingScript) const;
 
     QString presentationTemplate;
 };
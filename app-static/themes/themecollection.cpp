@@ -26,6 +26,11 @@ bool ThemeCollection::load(const QString &fileName)
 
 int ThemeCollection::insert(const Theme &theme)
 {
+    // keep the first theme if several themes have the same name
+    if (!themesByName.contains(theme.name())) {
+        themesByName.insert(theme.name(), themes.count());
+    }
+
     themesIndex << theme.name();
     themes << theme;
     return 0;
@@ -43,12 +48,12 @@ const Theme &ThemeCollection::at(int offset) const
 
 bool ThemeCollection::contains(const QString &name) const
 {
-    return themesIndex.contains(name);
+    return themesByName.contains(name);
 }
 
 const Theme ThemeCollection::theme(const QString &name) const
 {
-    return at(themesIndex.indexOf(name));
+    return at(themesByName.value(name, -1));
 }
 
 QStringList ThemeCollection::themeNames() const
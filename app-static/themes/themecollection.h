@@ -17,6 +17,7 @@
 #ifndef THEMECOLLECTION_H
 #define THEMECOLLECTION_H
 
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <jsoncollection.h>
@@ -40,6 +41,7 @@ public:
 
 private:
     QStringList themesIndex;
+    QHash<QString, int> themesByName;
     QList<Theme> themes;
 };
 
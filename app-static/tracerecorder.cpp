@@ -0,0 +1,255 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tracerecorder.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+
+// number of events kept per thread (must be a power of two)
+static const quint32 BUFFER_SIZE = 16384;
+
+// number of thread buffers kept at most
+static const int MAXIMUM_BUFFERS = 32;
+
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    qint64 begin;
+    qint64 duration;
+};
+
+// Ring buffer with a single writer, the thread it belongs to
+class TraceBuffer
+{
+public:
+    TraceBuffer(int threadId, const QString &threadName) :
+        threadId(threadId),
+        threadName(threadName),
+        events(new TraceEvent[BUFFER_SIZE]),
+        count(0),
+        inUse(1)
+    {
+    }
+
+    ~TraceBuffer()
+    {
+        delete[] events;
+    }
+
+    void append(const TraceEvent &event)
+    {
+        const quint32 index = count.load();
+        events[index & (BUFFER_SIZE - 1)] = event;
+        count.storeRelease(index + 1);
+    }
+
+    int threadId;
+    QString threadName;
+    TraceEvent *events;
+    QAtomicInteger<quint32> count;
+    QAtomicInt inUse;
+};
+
+// Gives the buffer of the current thread back when the thread
+// finishes. The events stay in the buffer, so they can still be
+// exported until another thread takes the buffer over.
+class ThreadBuffer
+{
+public:
+    ThreadBuffer() : buffer(0), assigned(false) {}
+
+    ~ThreadBuffer()
+    {
+        if (buffer) {
+            buffer->inUse.storeRelease(0);
+        }
+    }
+
+    TraceBuffer *buffer;
+    bool assigned;
+};
+
+static thread_local ThreadBuffer threadBuffer;
+
+
+TraceRecorder::TraceRecorder() :
+    enabled(0)
+{
+    timer.start();
+}
+
+TraceRecorder *TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return &recorder;
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    this->enabled.store(enabled ? 1 : 0);
+}
+
+qint64 TraceRecorder::timestamp() const
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::record(const char *name, const char *category, qint64 begin, qint64 end)
+{
+    TraceBuffer *buffer = currentBuffer();
+    if (buffer) {
+        TraceEvent event = { name, category, begin, end - begin };
+        buffer->append(event);
+    }
+}
+
+void TraceRecorder::clear()
+{
+    QMutexLocker locker(&mutex);
+    foreach (TraceBuffer *buffer, buffers) {
+        buffer->count.storeRelease(0);
+    }
+}
+
+QByteArray TraceRecorder::toJson() const
+{
+    QJsonArray traceEvents;
+
+    QMutexLocker locker(&mutex);
+    foreach (TraceBuffer *buffer, buffers) {
+        QJsonObject threadName;
+        threadName["name"] = buffer->threadName;
+
+        QJsonObject metadata;
+        metadata["name"] = QStringLiteral("thread_name");
+        metadata["ph"] = QStringLiteral("M");
+        metadata["pid"] = 1;
+        metadata["tid"] = buffer->threadId;
+        metadata["args"] = threadName;
+        traceEvents.append(metadata);
+
+        // the oldest events are overwritten by a thread that is still
+        // running, so only the second half of a full buffer is exported
+        const quint32 count = buffer->count.loadAcquire();
+        const quint32 available = count < BUFFER_SIZE ? count : BUFFER_SIZE / 2;
+        const quint32 first = count - available;
+
+        // copy the events before serializing them and drop the ones the
+        // thread overwrote in the meantime. The slot of an event is reused
+        // by the event BUFFER_SIZE later, which may be written already
+        // without being published in the count.
+        QVector<TraceEvent> events(available);
+        for (quint32 i = 0; i < available; ++i) {
+            events[i] = buffer->events[(first + i) & (BUFFER_SIZE - 1)];
+        }
+        const quint32 written = buffer->count.fetchAndAddOrdered(0);
+        const quint32 overwritten = written - first >= BUFFER_SIZE
+                                  ? qMin(written - first - BUFFER_SIZE + 1, available)
+                                  : 0;
+
+        for (quint32 i = overwritten; i < available; ++i) {
+            const TraceEvent &event = events.at(i);
+
+            QJsonObject object;
+            object["name"] = QString::fromLatin1(event.name);
+            object["cat"] = QString::fromLatin1(event.category);
+            object["ph"] = QStringLiteral("X");
+            object["ts"] = event.begin;
+            object["dur"] = event.duration;
+            object["pid"] = 1;
+            object["tid"] = buffer->threadId;
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = QStringLiteral("ms");
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool TraceRecorder::exportToFile(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    return file.write(toJson()) >= 0;
+}
+
+TraceBuffer *TraceRecorder::currentBuffer()
+{
+    if (!threadBuffer.assigned) {
+        QThread *thread = QThread::currentThread();
+
+        QString name = thread->objectName();
+        if (name.isEmpty()) {
+            name = (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+                 ? QStringLiteral("GUI")
+                 : QString::fromLatin1(thread->metaObject()->className());
+        }
+
+        QMutexLocker locker(&mutex);
+        threadBuffer.buffer = takeFreeBuffer(name);
+        threadBuffer.assigned = true;
+    }
+
+    return threadBuffer.buffer;
+}
+
+TraceBuffer *TraceRecorder::takeFreeBuffer(const QString &threadName)
+{
+    // continue the buffer of a finished thread with the same name,
+    // e.g. a pool thread that was expired and started again
+    TraceBuffer *freeBuffer = 0;
+    foreach (TraceBuffer *buffer, buffers) {
+        if (buffer->inUse.loadAcquire() == 0) {
+            if (buffer->threadName == threadName) {
+                buffer->inUse.storeRelease(1);
+                return buffer;
+            }
+            if (!freeBuffer) {
+                freeBuffer = buffer;
+            }
+        }
+    }
+
+    if (buffers.count() < MAXIMUM_BUFFERS) {
+        TraceBuffer *buffer = new TraceBuffer(buffers.count() + 1, threadName);
+        buffers.append(buffer);
+        return buffer;
+    }
+
+    // drop the events of a finished thread to make room, if all
+    // buffers are in use the events of this thread are not recorded
+    if (freeBuffer) {
+        freeBuffer->threadName = threadName;
+        freeBuffer->count.storeRelease(0);
+        freeBuffer->inUse.storeRelease(1);
+    }
+
+    return freeBuffer;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+
+#include "stallwatchdog.h"
+
+class TraceBuffer;
+
+
+// Records the activity of the GUI and worker threads as Chrome
+// trace events (viewable in Perfetto or chrome://tracing). Every thread
+// writes into its own ring buffer without locking, so a disabled
+// recorder costs only a single atomic load per span. The buffers of
+// finished threads are reused and their number is bounded.
+class TraceRecorder
+{
+public:
+    static TraceRecorder *instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled.load() != 0; }
+
+    qint64 timestamp() const;
+    void record(const char *name, const char *category, qint64 begin, qint64 end);
+    void clear();
+
+    QByteArray toJson() const;
+    bool exportToFile(const QString &fileName) const;
+
+private:
+    TraceRecorder();
+
+    TraceBuffer *currentBuffer();
+    TraceBuffer *takeFreeBuffer(const QString &threadName);
+
+    QAtomicInt enabled;
+    QElapsedTimer timer;
+    mutable QMutex mutex;
+    QList<TraceBuffer*> buffers;
+};
+
+
+// Records the lifetime of the object as a span of the current thread.
+// The name and category must be string literals. The span is also the
+// scope a stall of the event loop is attributed to.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, const char *category = "app") :
+        name(name),
+        category(category),
+        begin(-1),
+        scoped(StallWatchdog::enterScope(name))
+    {
+        TraceRecorder *recorder = TraceRecorder::instance();
+        if (recorder->isEnabled()) {
+            begin = recorder->timestamp();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (begin >= 0) {
+            TraceRecorder *recorder = TraceRecorder::instance();
+            recorder->record(name, category, begin, recorder->timestamp());
+        }
+
+        if (scoped) {
+            StallWatchdog::leaveScope();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *name;
+    const char *category;
+    qint64 begin;
+    bool scoped;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wordcounter.h"
+
+#include <QRegExp>
+
+
+int WordCounter::countWords(const QString &text)
+{
+    // empty or only whitespaces?
+    if (text.trimmed().isEmpty()) {
+        return 0;
+    }
+
+    int words = 0;
+    bool lastWasWhitespace = false;
+    bool firstCharacter = false;
+
+    for (int i = 0; i < text.count(); ++i) {
+        if (text.at(i).isSpace()) {
+            if (firstCharacter && !lastWasWhitespace) {
+                words++;
+            }
+            lastWasWhitespace = true;
+        }
+        else
+        {
+            firstCharacter = true;
+            lastWasWhitespace = false;
+        }
+    }
+
+    if (!lastWasWhitespace && text.count() > 0) {
+        words++;
+    }
+
+    return words;
+}
+
+static bool greaterThanMinimumWordLength(const QString &word)
+{
+    static const int MINIMUM_WORD_LENGTH = 3;
+    return word.length() > MINIMUM_WORD_LENGTH;
+}
+
+QStringList WordCounter::distinctWords(const QString &text)
+{
+    QStringList allWords = text.split(QRegExp("\\W+"), QString::SkipEmptyParts);
+    allWords.removeDuplicates();
+
+    QStringList words;
+    foreach (const QString &word, allWords) {
+        if (greaterThanMinimumWordLength(word)) {
+            words << word;
+        }
+    }
+    words.sort(Qt::CaseInsensitive);
+
+    return words;
+}
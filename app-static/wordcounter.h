@@ -14,25 +14,19 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#ifndef SAVEFILEADAPTER_H
-#define SAVEFILEADAPTER_H
+#ifndef WORDCOUNTER_H
+#define WORDCOUNTER_H
 
-#include <QSaveFile>
+#include <QString>
+#include <QStringList>
 
-
-class SaveFileAdapter : public QSaveFile
+class WordCounter
 {
 public:
-    SaveFileAdapter(const QString &name) :
-        QSaveFile(name)
-    {
-    }
-
-    void close() {
-        // IGNORE - work-around for the problem that QTextDocumentWriter::write()
-        // calls close() on the device
-    }
+    static int countWords(const QString &text);
 
+    // words longer than three characters, sorted case insensitive
+    static QStringList distinctWords(const QString &text);
 };
 
-#endif // SAVEFILEADAPTER_H
+#endif // WORDCOUNTER_H
@@ -45,6 +45,7 @@ SOURCES += \
     main.cpp\
     mainwindow.cpp \
     markdowneditor.cpp \
+    editorstylecache.cpp \
     controls/linenumberarea.cpp \
     controls/activelabel.cpp \
     controls/fileexplorerwidget.cpp \
@@ -53,17 +54,24 @@ SOURCES += \
     htmlpreviewgenerator.cpp \
     markdownhighlighter.cpp \
     highlightworkerthread.cpp \
+    documentscheduler.cpp \
+    markdownfileloader.cpp \
     markdownmanipulator.cpp \
+    filesaver.cpp \
     exportpdfdialog.cpp \
+    batchexportdialog.cpp \
+    batchexporter.cpp \
     exporthtmldialog.cpp \
     htmlhighlighter.cpp \
     options.cpp \
+    pdfexporter.cpp \
     optionsdialog.cpp \
     hunspell/spellchecker.cpp \
     controls/languagemenu.cpp \
     tabletooldialog.cpp \
     imagetooldialog.cpp \
     snippetcompleter.cpp \
+    startupprofiler.cpp \
     snippetstablemodel.cpp \
     aboutdialog.cpp \
     statusbarwidget.cpp
@@ -86,6 +94,7 @@ unix {
 HEADERS  += \
     mainwindow.h \
     markdowneditor.h \
+    editorstylecache.h \
     controls/linenumberarea.h \
     controls/activelabel.h \
     controls/fileexplorerwidget.h \
@@ -94,27 +103,34 @@ HEADERS  += \
     htmlpreviewgenerator.h \
     markdownhighlighter.h \
     highlightworkerthread.h \
+    documentscheduler.h \
+    markdownfileloader.h \
     markdownmanipulator.h \
     exportpdfdialog.h \
+    batchexportdialog.h \
+    batchexporter.h \
     exporthtmldialog.h \
     htmlhighlighter.h \
     options.h \
+    pdfexporter.h \
     optionsdialog.h \
     hunspell/spellchecker.h \
     controls/languagemenu.h \
     tabletooldialog.h \
     imagetooldialog.h \
     snippetcompleter.h \
+    startupprofiler.h \
     snippetstablemodel.h \
     aboutdialog.h \
     statusbarwidget.h \
-    savefileadapter.h
+    filesaver.h
 
 FORMS    += \
     mainwindow.ui \
     controls/fileexplorerwidget.ui \
     controls/findreplacewidget.ui \
     exportpdfdialog.ui \
+    batchexportdialog.ui \
     exporthtmldialog.ui \
     optionsdialog.ui \
     tabletooldialog.ui \
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "batchexportdialog.h"
+#include "ui_batchexportdialog.h"
+
+#include <QFileDialog>
+#include <QPushButton>
+
+BatchExportDialog::BatchExportDialog(const QString &directory, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::BatchExportDialog)
+{
+    ui->setupUi(this);
+
+    // change button text of standard Ok button
+    QPushButton *okButton = ui->buttonBox->button(QDialogButtonBox::Ok);
+    okButton->setText(tr("Export"));
+
+    ui->sourceLineEdit->setText(directory);
+    ui->exportToLineEdit->setText(directory);
+
+    // initialize Ok button state
+    updateOkButton();
+}
+
+BatchExportDialog::~BatchExportDialog()
+{
+    delete ui;
+}
+
+QString BatchExportDialog::sourceDirectory() const
+{
+    return ui->sourceLineEdit->text();
+}
+
+QString BatchExportDialog::outputDirectory() const
+{
+    return ui->exportToLineEdit->text();
+}
+
+bool BatchExportDialog::isPdfFormat() const
+{
+    return ui->formatComboBox->currentIndex() == 1;
+}
+
+bool BatchExportDialog::isSingleBook() const
+{
+    return ui->bookCheckBox->isChecked();
+}
+
+bool BatchExportDialog::includeCSS() const
+{
+    return ui->styleCheckBox->isChecked();
+}
+
+bool BatchExportDialog::includeCodeHighlighting() const
+{
+    return !isPdfFormat() && ui->highlightCheckBox->isChecked();
+}
+
+void BatchExportDialog::chooseSourceButtonClicked()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Export Folder..."), ui->sourceLineEdit->text());
+    if (!directory.isEmpty()) {
+        ui->sourceLineEdit->setText(directory);
+    }
+}
+
+void BatchExportDialog::chooseExportToButtonClicked()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Export to..."), ui->exportToLineEdit->text());
+    if (!directory.isEmpty()) {
+        ui->exportToLineEdit->setText(directory);
+    }
+}
+
+void BatchExportDialog::formatChanged(int index)
+{
+    Q_UNUSED(index)
+
+    // javascript is not executed in PDF files
+    ui->highlightCheckBox->setEnabled(!isPdfFormat());
+}
+
+void BatchExportDialog::updateOkButton()
+{
+    // only enable ok button if both directories were provided
+    QPushButton *okButton = ui->buttonBox->button(QDialogButtonBox::Ok);
+    okButton->setEnabled(!sourceDirectory().isEmpty() && !outputDirectory().isEmpty());
+}
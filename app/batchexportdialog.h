@@ -0,0 +1,51 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHEXPORTDIALOG_H
+#define BATCHEXPORTDIALOG_H
+
+#include <QDialog>
+
+namespace Ui {
+class BatchExportDialog;
+}
+
+class BatchExportDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit BatchExportDialog(const QString &directory, QWidget *parent = 0);
+    ~BatchExportDialog();
+
+    QString sourceDirectory() const;
+    QString outputDirectory() const;
+    bool isPdfFormat() const;
+    bool isSingleBook() const;
+    bool includeCSS() const;
+    bool includeCodeHighlighting() const;
+
+private slots:
+    void chooseSourceButtonClicked();
+    void chooseExportToButtonClicked();
+    void formatChanged(int index);
+    void updateOkButton();
+
+private:
+    Ui::BatchExportDialog *ui;
+};
+
+#endif // BATCHEXPORTDIALOG_H
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "batchexporter.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPrinter>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <converter/markdowndocument.h>
+
+#include "pdfexporter.h"
+#include "yamlheaderchecker.h"
+
+
+class ExportTask : public QRunnable
+{
+public:
+    ExportTask(BatchExporter *exporter, int index) : exporter(exporter), index(index) {}
+
+    void run() { exporter->exportFile(index); }
+
+private:
+    BatchExporter *exporter;
+    int index;
+};
+
+
+BatchExporter::BatchExporter(MarkdownConverter *converter, QObject *parent) :
+    QThread(parent),
+    converter(converter),
+    format(HtmlFormat),
+    singleBook(false),
+    yamlHeaderSupport(false),
+    exported(0),
+    failed(0),
+    bytes(0),
+    cancelled(0)
+{
+    // the first document initializes global tables of the Markdown
+    // library, this must not happen on several pool threads at once
+    QScopedPointer<MarkdownDocument> document(converter->createDocument(QStringLiteral("\n"), MarkdownConverter::ConverterOptions()));
+    converter->renderAsHtml(document.data());
+}
+
+BatchExporter::~BatchExporter()
+{
+    cancel();
+    wait();
+}
+
+void BatchExporter::setFiles(const QString &sourceDirectory, const QStringList &fileNames)
+{
+    this->sourceDirectory = sourceDirectory;
+    this->fileNames = fileNames;
+}
+
+void BatchExporter::setOutput(const QString &outputDirectory, Format format, bool singleBook)
+{
+    this->outputDirectory = outputDirectory;
+    this->format = format;
+    this->singleBook = singleBook;
+}
+
+void BatchExporter::setOptions(MarkdownConverter::ConverterOptions converterOptions, Template::RenderOptions renderOptions, bool yamlHeaderSupport)
+{
+    // source line anchors are only needed for the preview
+    this->converterOptions = converterOptions & ~MarkdownConverter::SourceLineOption;
+    this->renderOptions = renderOptions;
+    this->yamlHeaderSupport = yamlHeaderSupport;
+}
+
+void BatchExporter::setHeader(const QString &header)
+{
+    this->header = header;
+}
+
+QString BatchExporter::bookFileName() const
+{
+    const QString suffix = format == PdfFormat ? QStringLiteral(".pdf") : QStringLiteral(".html");
+    return QDir(outputDirectory).filePath(QDir(sourceDirectory).dirName() + suffix);
+}
+
+void BatchExporter::cancel()
+{
+    cancelled.store(1);
+}
+
+void BatchExporter::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    exported = 0;
+    failed = 0;
+    bytes = 0;
+    chapters = QVector<Chapter>(singleBook ? fileNames.size() : 0);
+
+    // documents are converted in parallel, the pool
+    // deletes the tasks after they are finished
+    QThreadPool pool;
+    for (int i = 0; i < fileNames.size(); ++i) {
+        pool.start(new ExportTask(this, i));
+    }
+    pool.waitForDone();
+
+    if (singleBook && !cancelled.load() && exported > 0 && !writeBook()) {
+        failed = fileNames.size();
+        exported = 0;
+    }
+    chapters.clear();
+
+    emit exportFinished(exported, failed, bytes, timer.elapsed());
+}
+
+void BatchExporter::exportFile(int index)
+{
+    if (cancelled.load()) {
+        return;
+    }
+
+    const QString fileName = fileNames.at(index);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        finishFile(false, 0);
+        return;
+    }
+
+    const QByteArray data = file.readAll();
+    QString text = QString::fromUtf8(data);
+
+    // cut YAML header
+    if (yamlHeaderSupport) {
+        YamlHeaderChecker checker(text);
+        if (checker.hasHeader()) {
+            text = checker.body();
+        }
+    }
+
+    QScopedPointer<MarkdownDocument> document(converter->createDocument(text, converterOptions));
+    const QString body = converter->renderAsHtml(document.data());
+
+    bool success = true;
+    if (singleBook) {
+        const QString toc = converter->renderAsTableOfContents(document.data());
+
+        QMutexLocker locker(&statisticsMutex);
+        chapters[index].body = body;
+        chapters[index].toc = toc;
+    } else {
+        // images are resolved relative to the document
+        const QUrl baseUrl = QUrl::fromLocalFile(QFileInfo(fileName).absolutePath() + QLatin1Char('/'));
+        success = writeOutput(outputFileName(fileName), body, baseUrl);
+    }
+
+    finishFile(success, data.size());
+}
+
+void BatchExporter::finishFile(bool success, qint64 size)
+{
+    int count;
+    {
+        QMutexLocker locker(&statisticsMutex);
+        if (success) {
+            exported++;
+            bytes += size;
+        } else {
+            failed++;
+        }
+        count = exported + failed;
+    }
+
+    emit progressChanged(count, fileNames.size());
+}
+
+// make the anchors of a chapter unique within the book
+static QString prefixAnchors(const QString &html, const QString &prefix)
+{
+    static const QRegularExpression anchorRx(QStringLiteral("(\\s(?:id|name)=\"|href=\"#)"));
+
+    QString result(html);
+    return result.replace(anchorRx, QStringLiteral("\\1") + prefix);
+}
+
+bool BatchExporter::writeBook()
+{
+    QString toc;
+    QString body;
+
+    for (int i = 0; i < chapters.size(); ++i) {
+        const QString id = QStringLiteral("chapter%1").arg(i + 1);
+        const QString prefix = id + QLatin1Char('-');
+        const QString title = QFileInfo(fileNames.at(i)).completeBaseName().toHtmlEscaped();
+
+        toc += QStringLiteral("<li><a href=\"#") + id + QStringLiteral("\">") + title + QStringLiteral("</a>\n")
+             + prefixAnchors(chapters.at(i).toc, prefix) + QStringLiteral("</li>\n");
+        body += QStringLiteral("<div class=\"chapter\" id=\"") + id + QStringLiteral("\">\n")
+              + prefixAnchors(chapters.at(i).body, prefix) + QStringLiteral("</div>\n");
+    }
+
+    const QUrl baseUrl = QUrl::fromLocalFile(QDir(sourceDirectory).absolutePath() + QLatin1Char('/'));
+    return writeOutput(bookFileName(), QStringLiteral("<ul class=\"toc\">\n") + toc + QStringLiteral("</ul>\n") + body, baseUrl);
+}
+
+bool BatchExporter::writeOutput(const QString &fileName, const QString &body, const QUrl &baseUrl)
+{
+    const QString html = converter->templateRenderer()->exportAsHtml(header, body, renderOptions);
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    if (format == PdfFormat) {
+        QPrinter printer;
+        printer.setOutputFormat(QPrinter::PdfFormat);
+        printer.setOutputFileName(fileName);
+
+        return PdfExporter::printDocument(html, baseUrl, &printer, cancelled);
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    file.write(html.toUtf8());
+    return file.commit();
+}
+
+QString BatchExporter::outputFileName(const QString &fileName) const
+{
+    // keep the folder structure of the exported files
+    const QString relativePath = QDir(sourceDirectory).relativeFilePath(fileName);
+    const QFileInfo info(QDir(outputDirectory).filePath(relativePath));
+    const QString suffix = format == PdfFormat ? QStringLiteral(".pdf") : QStringLiteral(".html");
+
+    return info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + suffix;
+}
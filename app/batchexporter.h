@@ -0,0 +1,99 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHEXPORTER_H
+#define BATCHEXPORTER_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qvector.h>
+
+#include <converter/markdownconverter.h>
+#include <template/template.h>
+
+
+// Exports all files of a folder concurrently on a thread pool, either
+// to one HTML or PDF file per document or to a single book with a
+// merged table of contents. The header with the shared assets is
+// built once and used for all documents.
+class BatchExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        HtmlFormat,
+        PdfFormat
+    };
+
+    // takes ownership of the converter
+    BatchExporter(MarkdownConverter *converter, QObject *parent = 0);
+    ~BatchExporter();
+
+    void setFiles(const QString &sourceDirectory, const QStringList &fileNames);
+    void setOutput(const QString &outputDirectory, Format format, bool singleBook);
+    void setOptions(MarkdownConverter::ConverterOptions converterOptions, Template::RenderOptions renderOptions, bool yamlHeaderSupport);
+    void setHeader(const QString &header);
+
+    QString bookFileName() const;
+
+    void cancel();
+
+signals:
+    void progressChanged(int exported, int count);
+    void exportFinished(int exported, int failed, qint64 bytes, qint64 milliseconds);
+
+protected:
+    virtual void run();
+
+private:
+    friend class ExportTask;
+
+    struct Chapter {
+        QString body;
+        QString toc;
+    };
+
+    void exportFile(int index);
+    void finishFile(bool success, qint64 size);
+    bool writeBook();
+    bool writeOutput(const QString &fileName, const QString &body, const QUrl &baseUrl);
+    QString outputFileName(const QString &fileName) const;
+
+private:
+    QScopedPointer<MarkdownConverter> converter;
+    QString sourceDirectory;
+    QStringList fileNames;
+    QString outputDirectory;
+    Format format;
+    bool singleBook;
+    MarkdownConverter::ConverterOptions converterOptions;
+    Template::RenderOptions renderOptions;
+    bool yamlHeaderSupport;
+    QString header;
+    QVector<Chapter> chapters;
+    QMutex statisticsMutex;
+    int exported;
+    int failed;
+    qint64 bytes;
+    QAtomicInt cancelled;
+};
+
+#endif // BATCHEXPORTER_H
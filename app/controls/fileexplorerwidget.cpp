@@ -27,19 +27,13 @@ protected:
 
 FileExplorerWidget::FileExplorerWidget(QWidget *parent) :
     QWidget(parent),
-    initialized(false),
     ui(new Ui::FileExplorerWidget),
-    model(new QFileSystemModel(this)),
+    model(0),
     sortModel(new FileSortFilterProxyModel(this))
 {
     ui->setupUi(this);
 
     sortModel->setDynamicSortFilter(true);
-    sortModel->setSourceModel(model);
-
-    ui->fileTreeView->setModel(sortModel);
-    ui->fileTreeView->hideColumn(1);
-    ui->fileTreeView->sortByColumn(0, Qt::AscendingOrder);
 
     connect(ui->fileTreeView, SIGNAL(doubleClicked(QModelIndex)),
             SLOT(fileOpen(QModelIndex)));
@@ -52,9 +46,16 @@ FileExplorerWidget::~FileExplorerWidget()
 
 void FileExplorerWidget::showEvent(QShowEvent *event)
 {
-    if (!initialized) {
+    // the file system model starts its own thread,
+    // so it is created when the explorer is shown the first time
+    if (!model) {
+        model = new QFileSystemModel(this);
         model->setRootPath("");
-        initialized = true;
+        sortModel->setSourceModel(model);
+
+        ui->fileTreeView->setModel(sortModel);
+        ui->fileTreeView->hideColumn(1);
+        ui->fileTreeView->sortByColumn(0, Qt::AscendingOrder);
     }
     QWidget::showEvent(event);
 }
@@ -28,7 +28,6 @@ private slots:
     void fileOpen(const QModelIndex &index);
 
 private:
-    bool initialized;
     Ui::FileExplorerWidget *ui;
     QFileSystemModel *model;
     QSortFilterProxyModel *sortModel;
@@ -19,6 +19,7 @@
 
 #include <QMenu>
 #include <QPlainTextEdit>
+#include <QTextBlock>
 
 FindReplaceWidget::FindReplaceWidget(QWidget *parent) :
     QWidget(parent),
@@ -91,20 +92,24 @@ void FindReplaceWidget::replaceClicked()
 
 void FindReplaceWidget::replaceAllClicked()
 {
+    if (!textEditor) return;
+
     QString oldText = ui->findLineEdit->text();
     QString newText = ui->replaceLineEdit->text();
 
-    textEditor->moveCursor(QTextCursor::Start);
-    QTextCursor cursor = textEditor->textCursor();
+    // find all matches before changing the document, so
+    // highlighter and preview are only updated once
+    QList<QPair<int, int> > matches = findAll(oldText);
+    if (matches.isEmpty()) return;
+
+    QTextCursor cursor(textEditor->document());
     cursor.beginEditBlock();
 
-    bool found = find(oldText);
-    while (found) {
-        QTextCursor tc = textEditor->textCursor();
-        if (tc.hasSelection()) {
-            tc.insertText(newText);
-        }
-        found = find(oldText);
+    // replace from back to front to keep the positions of the other matches valid
+    for (int i = matches.count() - 1; i >= 0; --i) {
+        cursor.setPosition(matches.at(i).first);
+        cursor.setPosition(matches.at(i).first + matches.at(i).second, QTextCursor::KeepAnchor);
+        cursor.insertText(newText);
     }
 
     cursor.endEditBlock();
@@ -185,3 +190,39 @@ bool FindReplaceWidget::findUsingRegExp(const QString &pattern, QTextDocument::F
     textEditor->setTextCursor(search);
     return true;
 }
+
+QList<QPair<int, int> > FindReplaceWidget::findAll(const QString &searchString) const
+{
+    QList<QPair<int, int> > matches;
+    if (searchString.isEmpty()) return matches;
+
+    Qt::CaseSensitivity cs = findCaseSensitively ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    QRegExp rx(searchString, cs, findUseRegExp ? QRegExp::RegExp : QRegExp::FixedString);
+
+    // like QTextDocument::find() matches never span multiple blocks
+    for (QTextBlock block = textEditor->document()->begin(); block.isValid(); block = block.next()) {
+        const QString text = block.text();
+
+        int index = rx.indexIn(text);
+        while (index >= 0) {
+            int length = rx.matchedLength();
+            if (length > 0 && (!findWholeWordsOnly || isWholeWord(text, index, length))) {
+                matches.append(qMakePair(block.position() + index, length));
+                index += length;
+            } else {
+                index++;
+            }
+
+            index = (index < text.length()) ? rx.indexIn(text, index) : -1;
+        }
+    }
+
+    return matches;
+}
+
+bool FindReplaceWidget::isWholeWord(const QString &text, int index, int length) const
+{
+    int end = index + length;
+    return (index == 0 || !text.at(index - 1).isLetterOrNumber())
+        && (end == text.length() || !text.at(end).isLetterOrNumber());
+}
@@ -58,6 +58,8 @@ private:
     void setupFindOptionsMenu();
     bool find(const QString &searchString, QTextDocument::FindFlags findOptions = 0) const;
     bool findUsingRegExp(const QString &pattern, QTextDocument::FindFlags findOptions = 0) const;
+    QList<QPair<int, int> > findAll(const QString &searchString) const;
+    bool isWholeWord(const QString &text, int index, int length) const;
 
     Ui::FindReplaceWidget *ui;
     QPlainTextEdit *textEditor;
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "documentscheduler.h"
+
+#include <QtCore/qthread.h>
+
+#include "tracerecorder.h"
+
+
+DocumentScheduler::DocumentScheduler() :
+    maximumRunning(qMax(2, QThread::idealThreadCount())),
+    running(0),
+    foregroundWaiting(0)
+{
+}
+
+DocumentScheduler *DocumentScheduler::instance()
+{
+    static DocumentScheduler scheduler;
+    return &scheduler;
+}
+
+void DocumentScheduler::setState(const QTextDocument *document, State state)
+{
+    QMutexLocker locker(&mutex);
+    documentStates.insert(document, state);
+    slotAvailable.wakeAll();
+}
+
+void DocumentScheduler::removeDocument(const QTextDocument *document)
+{
+    // unknown documents are treated as foreground documents, so this
+    // also releases workers still waiting for a suspended document
+    QMutexLocker locker(&mutex);
+    documentStates.remove(document);
+    slotAvailable.wakeAll();
+}
+
+void DocumentScheduler::beginWork(const QTextDocument *document)
+{
+    TraceSpan span("DocumentScheduler::beginWork", "scheduler");
+    QMutexLocker locker(&mutex);
+
+    // the state of the document may change while we are waiting
+    // (e.g. the user activates another window)
+    bool countedAsForeground = false;
+    forever {
+        State currentState = state(document);
+        if (currentState == Foreground && !countedAsForeground) {
+            foregroundWaiting++;
+            countedAsForeground = true;
+        } else if (currentState != Foreground && countedAsForeground) {
+            foregroundWaiting--;
+            countedAsForeground = false;
+        }
+
+        if (canRun(currentState)) {
+            break;
+        }
+
+        slotAvailable.wait(&mutex);
+    }
+
+    if (countedAsForeground) {
+        foregroundWaiting--;
+    }
+
+    running++;
+}
+
+void DocumentScheduler::endWork()
+{
+    QMutexLocker locker(&mutex);
+    running--;
+    slotAvailable.wakeAll();
+}
+
+DocumentScheduler::State DocumentScheduler::state(const QTextDocument *document) const
+{
+    return documentStates.value(document, Foreground);
+}
+
+bool DocumentScheduler::canRun(State state) const
+{
+    switch (state) {
+    case Foreground:
+        return running < maximumRunning;
+    case Background:
+        // background documents only run if no foreground work is pending
+        return running < maximumRunning && foregroundWaiting == 0;
+    case Suspended:
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DOCUMENTSCHEDULER_H
+#define DOCUMENTSCHEDULER_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+
+class QTextDocument;
+
+
+// Limits the number of parallel parses of all open documents.
+// Work of the document in the active window is always served first and
+// the workers of minimized windows are suspended until shown again.
+class DocumentScheduler
+{
+public:
+    enum State {
+        Foreground,
+        Background,
+        Suspended
+    };
+
+    static DocumentScheduler *instance();
+
+    void setState(const QTextDocument *document, State state);
+    void removeDocument(const QTextDocument *document);
+
+    void beginWork(const QTextDocument *document);
+    void endWork();
+
+private:
+    DocumentScheduler();
+
+    State state(const QTextDocument *document) const;
+    bool canRun(State state) const;
+
+    QHash<const QTextDocument*, State> documentStates;
+    QMutex mutex;
+    QWaitCondition slotAvailable;
+    int maximumRunning;
+    int running;
+    int foregroundWaiting;
+};
+
+
+// Reserves a slot of the DocumentScheduler for the lifetime of the object
+class ScheduledWork
+{
+public:
+    explicit ScheduledWork(const QTextDocument *document)
+    {
+        DocumentScheduler::instance()->beginWork(document);
+    }
+
+    ~ScheduledWork()
+    {
+        DocumentScheduler::instance()->endWork();
+    }
+
+private:
+    Q_DISABLE_COPY(ScheduledWork)
+};
+
+#endif // DOCUMENTSCHEDULER_H
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "editorstylecache.h"
+
+#include <QFile>
+#include <QRunnable>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <peg-markdown-highlight/styleparser.h>
+
+
+class StylePreloadTask : public QRunnable
+{
+public:
+    StylePreloadTask(const QStringList &fileNames, const QFont &font) :
+        fileNames(fileNames),
+        font(font)
+    {
+    }
+
+    void run()
+    {
+        EditorStyle style;
+        foreach (const QString &fileName, fileNames) {
+            EditorStyleCache::instance()->find(fileName, font, &style);
+        }
+    }
+
+private:
+    QStringList fileNames;
+    QFont font;
+};
+
+
+EditorStyleCache::EditorStyleCache()
+{
+}
+
+EditorStyleCache *EditorStyleCache::instance()
+{
+    static EditorStyleCache cache;
+    return &cache;
+}
+
+bool EditorStyleCache::find(const QString &fileName, const QFont &font, EditorStyle *style)
+{
+    const QString styleKey = key(fileName, font);
+
+    {
+        QMutexLocker locker(&mutex);
+        QHash<QString, EditorStyle>::const_iterator it = styles.constFind(styleKey);
+        if (it != styles.constEnd()) {
+            *style = it.value();
+            return true;
+        }
+    }
+
+    // parse outside of the lock, so a preloading thread
+    // doesn't block the GUI
+    if (!parse(fileName, font, style)) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    styles.insert(styleKey, *style);
+    return true;
+}
+
+void EditorStyleCache::preload(const QStringList &fileNames, const QFont &font)
+{
+    QThreadPool::globalInstance()->start(new StylePreloadTask(fileNames, font));
+}
+
+QString EditorStyleCache::key(const QString &fileName, const QFont &font)
+{
+    return font.key() + QLatin1Char('\n') + fileName;
+}
+
+bool EditorStyleCache::parse(const QString &fileName, const QFont &font, EditorStyle *style)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream ts(&f);
+    QString input = ts.readAll();
+
+    // parse the stylesheet
+    PegMarkdownHighlight::StyleParser parser(input);
+    style->highlightingStyles = parser.highlightingStyles(font);
+    style->palette = parser.editorPalette();
+
+    return true;
+}
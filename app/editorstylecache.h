@@ -0,0 +1,58 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EDITORSTYLECACHE_H
+#define EDITORSTYLECACHE_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvector.h>
+#include <QtGui/qfont.h>
+#include <QtGui/qpalette.h>
+
+#include "peg-markdown-highlight/definitions.h"
+
+
+struct EditorStyle
+{
+    QVector<PegMarkdownHighlight::HighlightingStyle> highlightingStyles;
+    QPalette palette;
+};
+
+
+// Keeps the parsed editor stylesheets per stylesheet and font, so
+// switching between themes doesn't parse the stylesheets again.
+// The stylesheets of all themes can be preloaded in the background.
+class EditorStyleCache
+{
+public:
+    static EditorStyleCache *instance();
+
+    bool find(const QString &fileName, const QFont &font, EditorStyle *style);
+    void preload(const QStringList &fileNames, const QFont &font);
+
+private:
+    EditorStyleCache();
+
+    static QString key(const QString &fileName, const QFont &font);
+    static bool parse(const QString &fileName, const QFont &font, EditorStyle *style);
+
+    QMutex mutex;
+    QHash<QString, EditorStyle> styles;
+};
+
+#endif // EDITORSTYLECACHE_H
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "filesaver.h"
+
+#include <QSaveFile>
+
+
+FileSaver::FileSaver(QObject *parent) :
+    QThread(parent),
+    busy(false)
+{
+}
+
+void FileSaver::save(const QString &fileName, const QString &text, int revision)
+{
+    QMutexLocker locker(&tasksMutex);
+    tasks.enqueue(SaveTask {fileName, text, revision});
+    bufferNotEmpty.wakeOne();
+}
+
+bool FileSaver::waitForSaved(const QString &fileName)
+{
+    QMutexLocker locker(&tasksMutex);
+    while (busy || !tasks.isEmpty()) {
+        allSaved.wait(&tasksMutex);
+    }
+
+    return !failedFiles.contains(fileName);
+}
+
+void FileSaver::stop()
+{
+    // a task without file name ends processing
+    save(QString(), QString(), 0);
+    wait();
+}
+
+void FileSaver::run()
+{
+    forever {
+        QList<SaveTask> pendingTasks;
+
+        {
+            // wait for new task
+            QMutexLocker locker(&tasksMutex);
+            while (tasks.count() == 0) {
+                bufferNotEmpty.wait(&tasksMutex);
+            }
+
+            // only the last of several saves to the same file needs
+            // to be written (e.g. because the user saves repeatedly)
+            while (!tasks.isEmpty()) {
+                SaveTask task = tasks.dequeue();
+                if (!pendingTasks.isEmpty() && pendingTasks.last().fileName == task.fileName) {
+                    pendingTasks.removeLast();
+                }
+                pendingTasks.append(task);
+            }
+
+            busy = true;
+        }
+
+        bool stopped = false;
+        foreach (const SaveTask &task, pendingTasks) {
+            // end processing?
+            if (task.fileName.isEmpty()) {
+                stopped = true;
+                break;
+            }
+
+            bool success = write(task);
+
+            // the result of each file is kept, not only of the last one
+            {
+                QMutexLocker locker(&tasksMutex);
+                if (success) {
+                    failedFiles.remove(task.fileName);
+                } else {
+                    failedFiles.insert(task.fileName);
+                }
+            }
+
+            emit saved(task.fileName, task.revision, success);
+        }
+
+        {
+            QMutexLocker locker(&tasksMutex);
+            busy = false;
+            allSaved.wakeAll();
+        }
+
+        if (stopped) {
+            return;
+        }
+    }
+}
+
+bool FileSaver::write(const SaveTask &task)
+{
+    // QSaveFile only replaces the file if everything was written
+    QSaveFile file(task.fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    file.write(task.text.toUtf8());
+
+    return file.commit();
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include <QtCore/qthread.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+#include <QtCore/qwaitcondition.h>
+
+struct SaveTask
+{
+    QString fileName;
+    QString text;
+    int revision;
+};
+
+class FileSaver : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit FileSaver(QObject *parent = 0);
+
+    void save(const QString &fileName, const QString &text, int revision);
+    // waits for all queued saves, returns false if the last save of the file failed
+    bool waitForSaved(const QString &fileName);
+    void stop();
+
+signals:
+    void saved(const QString &fileName, int revision, bool success);
+
+protected:
+    virtual void run();
+
+private:
+    bool write(const SaveTask &task);
+
+private:
+    QQueue<SaveTask> tasks;
+    QMutex tasksMutex;
+    QWaitCondition bufferNotEmpty;
+    QWaitCondition allSaved;
+    bool busy;
+    QSet<QString> failedFiles;
+};
+
+#endif // FILESAVER_H
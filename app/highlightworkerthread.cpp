@@ -16,38 +16,44 @@
  */
 #include "highlightworkerthread.h"
 
-#include "pmh_parser.h"
+#include "peg-markdown-highlight/pmhchunkedparser.h"
+#include "documentscheduler.h"
+#include "latencytracer.h"
+#include "tracerecorder.h"
 
 HighlightWorkerThread::HighlightWorkerThread(QObject *parent) :
-    QThread(parent)
+    QThread(parent),
+    sourceDocument(0)
 {
 }
 
+void HighlightWorkerThread::setSourceDocument(const QTextDocument *document)
+{
+    sourceDocument = document;
+}
+
 
-void HighlightWorkerThread::enqueue(const QString &text, unsigned long offset)
+void HighlightWorkerThread::enqueue(const QString &text, unsigned long offset, int revision)
 {
-    QMutexLocker locker(&tasksMutex);
-    tasks.enqueue(Task {text, offset});
-    bufferNotEmpty.wakeOne();
+    // replaces a task the worker hasn't started yet
+    tasks.post(Task {text, offset, revision});
+}
+
+int HighlightWorkerThread::isParseCancelled(void *context)
+{
+    // a newer task makes the running parse obsolete
+    HighlightWorkerThread *thread = static_cast<HighlightWorkerThread*>(context);
+    return !thread->tasks.isEmpty();
 }
 
 
 void HighlightWorkerThread::run()
 {
-    forever {
-        Task task;
-
-        {
-            // wait for new task
-            QMutexLocker locker(&tasksMutex);
-            while (tasks.count() == 0) {
-                bufferNotEmpty.wait(&tasksMutex);
-            }
+    LatencyTracer *tracer = LatencyTracer::instance();
 
-            // get last task from queue and skip all previous tasks
-            while (!tasks.isEmpty())
-                task = tasks.dequeue();
-        }
+    forever {
+        // wait for new task, previous tasks were already skipped
+        Task task = tasks.take();
 
         // end processing?
         if (task.text.isNull()) {
@@ -56,15 +62,33 @@ void HighlightWorkerThread::run()
 
         // delay processing by 500 ms to see if more tasks are coming
         // (e.g. because the user is typing fast)
-        this->msleep(500);
+        {
+            TraceSpan span("HighlightWorkerThread::delay", "worker");
+            this->msleep(500);
+        }
+
+        // wait until the scheduler lets this document run
+        ScheduledWork work(sourceDocument);
 
         // no more new tasks?
         if (tasks.isEmpty()) {
-            // parse markdown and generate syntax elements
+            TraceSpan span("HighlightWorkerThread::parse", "worker");
+            tracer->mark(sourceDocument, task.revision, LatencyTracer::HighlightStarted);
+
+            // parse markdown and generate syntax elements, large documents
+            // are parsed in parallel chunks and the parse is aborted as
+            // soon as a newer text is enqueued
             pmh_element **elements;
-            pmh_markdown_to_elements(task.text.toUtf8().data(), pmh_EXT_NONE, &elements);
+            {
+                TraceSpan span("pmh_markdown_to_elements", "parser");
+                elements = PmhChunkedParser::parse(task.text, pmh_EXT_NONE, isParseCancelled, this);
+            }
+            if (!elements) {
+                continue;
+            }
+            tracer->mark(sourceDocument, task.revision, LatencyTracer::HighlightParsed);
 
-            emit resultReady(elements, task.offset);
+            emit resultReady(elements, task.offset, task.revision);
         }
     }
 }
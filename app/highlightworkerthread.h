@@ -18,16 +18,17 @@
 #define HIGHLIGHTWORKERTHREAD_H
 
 #include <QtCore/qthread.h>
-#include <QtCore/qqueue.h>
-#include <QtCore/qmutex.h>
-#include <QtCore/qwaitcondition.h>
 
 #include "pmh_definitions.h"
+#include "latestvaluemailbox.h"
+
+class QTextDocument;
 
 struct Task
 {
     QString text;
     unsigned long offset;
+    int revision;
 };
 
 class HighlightWorkerThread : public QThread
@@ -37,18 +38,20 @@ class HighlightWorkerThread : public QThread
 public:
     explicit HighlightWorkerThread(QObject *parent = 0);
 
-    void enqueue(const QString &text, unsigned long offset = 0);
+    void setSourceDocument(const QTextDocument *document);
+    void enqueue(const QString &text, unsigned long offset = 0, int revision = 0);
 
 signals:
-    void resultReady(pmh_element **elements, unsigned long offset);
+    void resultReady(pmh_element **elements, unsigned long offset, int revision);
 
 protected:
     virtual void run();
 
 private:
-    QQueue<Task> tasks;
-    QMutex tasksMutex;
-    QWaitCondition bufferNotEmpty;
+    static int isParseCancelled(void *context);
+
+    const QTextDocument *sourceDocument;
+    LatestValueMailbox<Task> tasks;
 };
 
 #endif // HIGHLIGHTWORKERTHREAD_H
@@ -16,10 +16,9 @@
  */
 #include "htmlpreviewgenerator.h"
 
-#include <QFile>
-
 #include <converter/markdownconverter.h>
 #include <converter/markdowndocument.h>
+#include <converter/chunkedmarkdownconverter.h>
 #include <converter/discountmarkdownconverter.h>
 #include <converter/revealmarkdownconverter.h>
 
@@ -27,8 +26,13 @@
 #include <converter/hoedownmarkdownconverter.h>
 #endif
 
+#include <template/highlightjssupport.h>
 #include <template/template.h>
 
+#include "documentscheduler.h"
+#include "fragmentcache.h"
+#include "latencytracer.h"
+#include "tracerecorder.h"
 #include "options.h"
 #include "yamlheaderchecker.h"
 
@@ -36,7 +40,11 @@ HtmlPreviewGenerator::HtmlPreviewGenerator(Options *opt, QObject *parent) :
     QThread(parent),
     options(opt),
     document(0),
-    converter(0)
+    exportDocument(0),
+    converter(0),
+    sourceDocument(0),
+    scopeId(FragmentCache::createScopeId()),
+    documentRevision(0)
 {
     connect(options, SIGNAL(markdownConverterChanged()), SLOT(markdownConverterChanged()));
     markdownConverterChanged();
@@ -47,42 +55,41 @@ bool HtmlPreviewGenerator::isSupported(MarkdownConverter::ConverterOption option
     return converter->supportedOptions().testFlag(option);
 }
 
-void HtmlPreviewGenerator::markdownTextChanged(const QString &text)
+void HtmlPreviewGenerator::setSourceDocument(const QTextDocument *document)
+{
+    sourceDocument = document;
+}
+
+void HtmlPreviewGenerator::markdownTextChanged(const QString &text, int revision)
 {
     // cut YAML header
     YamlHeaderChecker checker(text);
     QString actualText = checker.hasHeader() && options->isYamlHeaderSupportEnabled() ?
                             checker.body()
                           : text;
-    // enqueue task to parse the markdown text and generate a new HTML document
-    QMutexLocker locker(&tasksMutex);
-    tasks.enqueue(actualText);
-    bufferNotEmpty.wakeOne();
+
+    // keep line numbers of the source line anchors in sync with the editor
+    if (actualText.length() < text.length() && isSupported(MarkdownConverter::SourceLineOption)) {
+        actualText.prepend(QString(checker.header().count(QLatin1Char('\n')), QLatin1Char('\n')));
+    }
+    // post task to parse the markdown text and generate a new HTML document,
+    // it replaces a task the worker hasn't started yet
+    tasks.post(Task {actualText, revision});
 }
 
 QString HtmlPreviewGenerator::exportHtml(const QString &styleSheet, const QString &highlightingScript)
 {
+    // the worker replaces the documents after every change
+    QMutexLocker locker(&documentMutex);
+
     if (!document) return QString();
 
-    QString header;
-    if (!styleSheet.isEmpty()) {
-        header += QString("\n<style>%1</style>").arg(styleSheet);
-    }
+    QString header = HighlightJsSupport::buildExportHeader(styleSheet, highlightingScript, converter->templateRenderer()->codeHighlightingStyle());
 
-    if (!highlightingScript.isEmpty()) {
-        // FIXME: doesn't really belong here
-        QString highlightStyle;
-        QFile f(QString(":/scripts/highlight.js/styles/%1.css").arg(converter->templateRenderer()->codeHighlightingStyle()));
-        if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            highlightStyle = f.readAll();
-        }
-
-        header += QString("\n<style>%1</style>").arg(highlightStyle);
-        header += QString("\n<script>%1</script>").arg(highlightingScript);
-        header += "\n<script>hljs.initHighlightingOnLoad();</script>";
-    }
+    MarkdownDocument *doc = exportDocument ? exportDocument : document;
 
-    return converter->templateRenderer()->exportAsHtml(header, converter->renderAsHtml(document), renderOptions());
+    FragmentCache::Scope scope(scopeId);
+    return converter->templateRenderer()->exportAsHtml(header, converter->renderAsHtml(doc), renderOptions());
 }
 
 void HtmlPreviewGenerator::setMathSupportEnabled(bool enabled)
@@ -119,50 +126,58 @@ void HtmlPreviewGenerator::setCodeHighlightingStyle(const QString &style)
 
 void HtmlPreviewGenerator::markdownConverterChanged()
 {
-    QString style;
+    // a PDF export may still render with the previous converter
+    QMutexLocker locker(&documentMutex);
 
-    if (converter) {
-        style = converter->templateRenderer()->codeHighlightingStyle();
-        delete converter;
-    }
+    // the new converter takes over the code highlighting style
+    MarkdownConverter *previousConverter = converter;
+    converter = createConverter();
+    delete previousConverter;
+}
+
+MarkdownConverter *HtmlPreviewGenerator::createConverter() const
+{
+    MarkdownConverter *markdownConverter;
 
     switch (options->markdownConverter()) {
 #ifdef ENABLE_HOEDOWN
     case Options::HoedownMarkdownConverter:
-        converter = new HoedownMarkdownConverter();
-        converter->templateRenderer()->setCodeHighlightingStyle(style);
+        markdownConverter = new HoedownMarkdownConverter();
         break;
 #endif
 
     case Options::RevealMarkdownConverter:
-        converter = new RevealMarkdownConverter();
-        converter->templateRenderer()->setCodeHighlightingStyle(style);
+        markdownConverter = new RevealMarkdownConverter();
         break;
 
     case Options::DiscountMarkdownConverter:
     default:
-        converter = new DiscountMarkdownConverter();
-        converter->templateRenderer()->setCodeHighlightingStyle(style);
+        markdownConverter = new DiscountMarkdownConverter();
         break;
     }
+
+    // slides are already rendered separately
+    if (options->isParallelRenderingEnabled() && options->markdownConverter() != Options::RevealMarkdownConverter) {
+        markdownConverter = new ChunkedMarkdownConverter(markdownConverter);
+    }
+
+    // e.g. for batch export, which embeds the style in the header
+    if (converter) {
+        markdownConverter->templateRenderer()->setCodeHighlightingStyle(converter->templateRenderer()->codeHighlightingStyle());
+    }
+
+    return markdownConverter;
 }
 
 void HtmlPreviewGenerator::run()
 {
-    forever {
-        QString text;
-
-        {
-            // wait for new task
-            QMutexLocker locker(&tasksMutex);
-            while (tasks.count() == 0) {
-                bufferNotEmpty.wait(&tasksMutex);
-            }
+    LatencyTracer *tracer = LatencyTracer::instance();
 
-            // get last task from queue and skip all previous tasks
-            while (!tasks.isEmpty())
-                text = tasks.dequeue();
-        }
+    forever {
+        // wait for new task, previous tasks were already skipped
+        const Task task = tasks.take();
+        const QString &text = task.text;
+        const int revision = task.revision;
 
         // end processing?
         if (text.isNull()) {
@@ -171,15 +186,43 @@ void HtmlPreviewGenerator::run()
 
         // delay processing to see if more tasks are coming
         // (e.g. because the user is typing fast)
-        this->msleep(calculateDelay(text));
+        {
+            TraceSpan span("HtmlPreviewGenerator::delay", "worker");
+            this->msleep(calculateDelay(text));
+        }
+
+        // wait until the scheduler lets this document run
+        ScheduledWork work(sourceDocument);
 
         // no more new tasks?
         if (tasks.isEmpty()) {
-            // delete previous markdown document
-            delete document;
+            TraceSpan span("HtmlPreviewGenerator::generate", "worker");
+            tracer->mark(sourceDocument, revision, LatencyTracer::PreviewStarted);
 
             // generate HTML from markdown
-            document = converter->createDocument(text, converterOptions());
+            MarkdownDocument *newDocument;
+            MarkdownDocument *newExportDocument = 0;
+            {
+                TraceSpan span("MarkdownConverter::createDocument", "converter");
+                newDocument = converter->createDocument(text, converterOptions());
+
+                // source line anchors are only needed for the preview
+                if (converterOptions().testFlag(MarkdownConverter::SourceLineOption)) {
+                    newExportDocument = converter->createDocument(text, converterOptions() & ~MarkdownConverter::SourceLineOption);
+                }
+            }
+
+            // delete previous markdown documents
+            {
+                QMutexLocker locker(&documentMutex);
+                delete document;
+                delete exportDocument;
+                document = newDocument;
+                exportDocument = newExportDocument;
+            }
+            documentRevision = revision;
+            tracer->mark(sourceDocument, revision, LatencyTracer::PreviewParsed);
+
             generateHtmlFromMarkdown();
 
             // generate table of contents
@@ -192,14 +235,32 @@ void HtmlPreviewGenerator::generateHtmlFromMarkdown()
 {
     if (!document) return;
 
-    QString html = converter->templateRenderer()->render(converter->renderAsHtml(document), renderOptions());
-    emit htmlResultReady(html);
+    // also called synchronously from the GUI thread if an option changes
+    TraceSpan span("HtmlPreviewGenerator::generateHtmlFromMarkdown", "converter");
+
+    QString body;
+    {
+        TraceSpan span("MarkdownConverter::renderAsHtml", "converter");
+        body = converter->renderAsHtml(document);
+    }
+
+    QString html;
+    {
+        TraceSpan span("Template::render", "template");
+        FragmentCache::Scope scope(scopeId);
+        html = converter->templateRenderer()->render(body, renderOptions());
+    }
+    LatencyTracer::instance()->mark(sourceDocument, documentRevision, LatencyTracer::PreviewRendered);
+
+    emit htmlResultReady(html, documentRevision);
 }
 
 void HtmlPreviewGenerator::generateTableOfContents()
 {
     if (!document) return;
 
+    TraceSpan span("MarkdownConverter::renderAsTableOfContents", "converter");
+
     QString toc = converter->renderAsTableOfContents(document);
     QString styledToc = QString("<html><head>\n<style type=\"text/css\">ul { list-style-type: none; padding: 0; margin-left: 1em; } a { text-decoration: none; }</style>\n</head><body>%1</body></html>").arg(toc);
     emit tocResultReady(styledToc);
@@ -244,6 +305,11 @@ MarkdownConverter::ConverterOptions HtmlPreviewGenerator::converterOptions() con
         parserOptionFlags |= MarkdownConverter::NoSuperscriptOption;
     }
 
+    // anchors for scrollbar synchronization
+    if (converter->supportedOptions().testFlag(MarkdownConverter::SourceLineOption)) {
+        parserOptionFlags |= MarkdownConverter::SourceLineOption;
+    }
+
     return parserOptionFlags;
 }
 
@@ -18,15 +18,15 @@
 #define HTMLPREVIEWGENERATOR_H
 
 #include <QtCore/qthread.h>
-#include <QtCore/qqueue.h>
 #include <QtCore/qmutex.h>
-#include <QtCore/qwaitcondition.h>
 
 #include <converter/markdownconverter.h>
 #include <template/template.h>
+#include <latestvaluemailbox.h>
 
 class MarkdownDocument;
 class Options;
+class QTextDocument;
 
 class HtmlPreviewGenerator : public QThread
 {
@@ -36,9 +36,15 @@ public:
     explicit HtmlPreviewGenerator(Options *opt, QObject *parent = 0);
     
     bool isSupported(MarkdownConverter::ConverterOption option) const;
+    void setSourceDocument(const QTextDocument *document);
+    quint64 fragmentScopeId() const { return scopeId; }
+
+    MarkdownConverter *createConverter() const;
+    MarkdownConverter::ConverterOptions converterOptions() const;
+    Template::RenderOptions renderOptions() const;
 
 public slots:
-    void markdownTextChanged(const QString &text);
+    void markdownTextChanged(const QString &text, int revision = 0);
     QString exportHtml(const QString &styleSheet, const QString &highlightingScript);
 
     void setMathSupportEnabled(bool enabled);
@@ -49,26 +55,33 @@ public slots:
     void markdownConverterChanged();
 
 signals:
-    void htmlResultReady(const QString &html);
+    void htmlResultReady(const QString &html, int revision);
     void tocResultReady(const QString &toc);
 
 protected:
     virtual void run();
 
 private:
+    struct Task
+    {
+        QString text;
+        int revision;
+    };
+
     void generateHtmlFromMarkdown();
     void generateTableOfContents();
-    MarkdownConverter::ConverterOptions converterOptions() const;
-    Template::RenderOptions renderOptions() const;
     int calculateDelay(const QString &text);
 
 private:
     Options *options;
     MarkdownDocument *document;
+    MarkdownDocument *exportDocument;
+    QMutex documentMutex;
     MarkdownConverter *converter;
-    QQueue<QString> tasks;
-    QMutex tasksMutex;
-    QWaitCondition bufferNotEmpty;
+    const QTextDocument *sourceDocument;
+    quint64 scopeId;
+    int documentRevision;
+    LatestValueMailbox<Task> tasks;
 };
 
 #endif // HTMLPREVIEWGENERATOR_H
@@ -14,7 +14,11 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include "latencytracer.h"
 #include "mainwindow.h"
+#include "stallwatchdog.h"
+#include "startupprofiler.h"
+#include "tracerecorder.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
@@ -52,6 +56,8 @@ static void associateFileTypes(const QStringList &fileTypes)
 
 int main(int argc, char *argv[])
 {
+    StartupProfiler::instance()->mark("process started");
+
     QApplication app(argc, argv);
     app.setOrganizationName("CuteMarkEd Project");
     app.setApplicationName("CuteMarkEd");
@@ -82,8 +88,30 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addPositionalArgument("file", QApplication::translate("main", "The file to open."));
+    QCommandLineOption profileStartupOption("profile-startup",
+        QApplication::translate("main", "Print the duration of the startup phases."));
+    parser.addOption(profileStartupOption);
+    QCommandLineOption traceLatencyOption("trace-latency",
+        QApplication::translate("main", "Trace the latency from a keystroke to the updated preview."));
+    parser.addOption(traceLatencyOption);
+    QCommandLineOption traceEventsOption("trace-events",
+        QApplication::translate("main", "Write the activity of the worker threads as Chrome trace events to <file>."),
+        QApplication::translate("main", "file"));
+    parser.addOption(traceEventsOption);
+    QCommandLineOption detectStallsOption("detect-stalls",
+        QApplication::translate("main", "Log stalls of the event loop longer than <ms> milliseconds."),
+        QApplication::translate("main", "ms"));
+    parser.addOption(detectStallsOption);
+    QCommandLineOption stallBacktraceOption("stall-backtrace",
+        QApplication::translate("main", "Add a backtrace to the logged stalls (Linux only)."));
+    parser.addOption(stallBacktraceOption);
     parser.process(app);
 
+    TraceRecorder::instance()->setEnabled(parser.isSet(traceEventsOption));
+    LatencyTracer::instance()->setEnabled(parser.isSet(traceLatencyOption));
+    StartupProfiler::instance()->setEnabled(parser.isSet(profileStartupOption));
+    StartupProfiler::instance()->mark("application initialized");
+
     // get filename from command line arguments
     QString fileName;
     const QStringList cmdLineArgs = parser.positionalArguments();
@@ -91,8 +119,28 @@ int main(int argc, char *argv[])
         fileName = cmdLineArgs.at(0);
     }
 
-    MainWindow w(fileName);
-    w.show();
+    int result;
+    {
+        MainWindow w(fileName);
+        StartupProfiler::instance()->mark("main window created");
+
+        w.show();
+        StartupProfiler::instance()->mark("main window shown");
+
+        if (parser.isSet(detectStallsOption)) {
+            StallWatchdog::instance()->setBacktraceEnabled(parser.isSet(stallBacktraceOption));
+            StallWatchdog::instance()->startWatching(qMax(1, parser.value(detectStallsOption).toInt()));
+        }
+
+        result = app.exec();
+    }
+
+    StallWatchdog::instance()->stopWatching();
+
+    // the window has stopped its worker threads
+    if (TraceRecorder::instance()->isEnabled()) {
+        TraceRecorder::instance()->exportToFile(parser.value(traceEventsOption));
+    }
 
-    return app.exec();
+    return result;
 }
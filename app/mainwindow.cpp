@@ -18,6 +18,7 @@
 #include "ui_mainwindow.h"
 
 #include <QClipboard>
+#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QDirIterator>
 #include <QFileDialog>
@@ -30,25 +31,26 @@
 #include <QNetworkProxy>
 #include <QPrintDialog>
 #include <QPrinter>
-#include <QProcess>
 #include <QScrollBar>
 #include <QSettings>
 #include <QStandardPaths>
-#include <QTextDocumentWriter>
 #include <QTimer>
+#include <QUuid>
 #include <QWebFrame>
 #include <QWebPage>
-#include <QWebInspector>
 
 #ifdef Q_OS_WIN
 #include <QWinJumpList>
 #include <QWinJumpListCategory>
 #endif
 
+#include <autosavejournal.h>
+#include <documentfragmentcache.h>
 #include <jsonfile.h>
 #include <snippets/jsonsnippettranslatorfactory.h>
 #include <snippets/snippetcollection.h>
 #include <spellchecker/dictionary.h>
+#include <template/highlightjssupport.h>
 #include <themes/stylemanager.h>
 #include <themes/themecollection.h>
 #include <datalocation.h>
@@ -57,22 +59,34 @@
 #include "controls/languagemenu.h"
 #include "controls/recentfilesmenu.h"
 #include "aboutdialog.h"
+#include "batchexportdialog.h"
+#include "batchexporter.h"
+#include "documentscheduler.h"
+#include "editorstylecache.h"
 #include "htmlpreviewcontroller.h"
 #include "htmlpreviewgenerator.h"
 #include "htmlviewsynchronizer.h"
 #include "htmlhighlighter.h"
+#include "latencytracer.h"
+#include "tracerecorder.h"
 #include "imagetooldialog.h"
+#include "markdownfileloader.h"
 #include "markdownmanipulator.h"
 #include "exporthtmldialog.h"
 #include "exportpdfdialog.h"
+#include "filesaver.h"
 #include "options.h"
+#include "pdfexporter.h"
 #include "optionsdialog.h"
 #include "revealviewsynchronizer.h"
-#include "savefileadapter.h"
 #include "snippetcompleter.h"
+#include "stallwatchdog.h"
+#include "startupprofiler.h"
 #include "tabletooldialog.h"
 #include "statusbarwidget.h"
 
+static const qint64 LARGE_FILE_SIZE = 4 * 1024 * 1024;
+
 MainWindow::MainWindow(const QString &fileName, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
@@ -82,21 +96,48 @@ MainWindow::MainWindow(const QString &fileName, QWidget *parent) :
     generator(new HtmlPreviewGenerator(options, this)),
     snippetCollection(new SnippetCollection(this)),
     viewSynchronizer(0),
+    fragmentCache(0),
     htmlPreviewController(0),
     themeCollection(new ThemeCollection()),
+    fileLoader(0),
+    loadGeneration(0),
+    fileSaver(new FileSaver(this)),
+    pdfExporter(0),
+    batchExporter(0),
+    journal(0),
+    previousJournal(0),
+    journalRevision(0),
+    previewRevision(-1),
     splitFactor(0.5),
-    rightViewCollapsed(false)
+    rightViewCollapsed(false),
+    dictionariesLoaded(false)
 {
     ui->setupUi(this);
     setupUi();
 
     setFileName(fileName);
 
+    connect(fileSaver, SIGNAL(saved(QString,int,bool)),
+            this, SLOT(fileSaved(QString,int,bool)));
+    fileSaver->start();
+
     QTimer::singleShot(0, this, SLOT(initializeApp()));
 }
 
 MainWindow::~MainWindow()
 {
+    // release workers that wait for this document
+    DocumentScheduler::instance()->removeDocument(ui->plainTextEdit->document());
+
+    cancelLoading();
+
+    // unfinished exports are discarded
+    delete pdfExporter;
+    delete batchExporter;
+
+    // finish pending saves
+    fileSaver->stop();
+
     delete viewSynchronizer;
 
     // stop background HTML preview generator
@@ -107,10 +148,20 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::changeEvent(QEvent *e)
+{
+    if (e->type() == QEvent::ActivationChange || e->type() == QEvent::WindowStateChange) {
+        updateSchedulingState();
+    }
+
+    QMainWindow::changeEvent(e);
+}
+
 void MainWindow::closeEvent(QCloseEvent *e)
 {
     // check if file needs saving
     if (maybeSave()) {
+        stopJournal();
         writeSettings();
         e->accept();
     } else {
@@ -130,12 +181,26 @@ void MainWindow::initializeApp()
     ui->webView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
     ui->tocWebView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
 
+    StartupProfiler *profiler = StartupProfiler::instance();
+    profiler->mark("initialization started");
+
     themeCollection->load(":/builtin-htmlpreview-themes.json");
     loadCustomStyles();
     setupHtmlPreviewThemes();
+    profiler->mark("themes loaded");
 
     // apply last used theme
     lastUsedTheme();
+    profiler->mark("last used theme applied");
+
+    // parse the editor styles of the other themes in the background
+    QStringList editorStyles;
+    foreach (const QString &themeName, themeCollection->themeNames()) {
+        Theme theme = themeCollection->theme(themeName);
+        editorStyles << stylePath(StyleManager::markdownHighlightingPath(theme));
+    }
+    editorStyles.removeDuplicates();
+    EditorStyleCache::instance()->preload(editorStyles, ui->plainTextEdit->font());
 
     ui->plainTextEdit->tabWidthChanged(options->tabWidth());
     ui->plainTextEdit->rulerEnabledChanged(options->isRulerEnabled());
@@ -159,23 +224,34 @@ void MainWindow::initializeApp()
     ui->actionCheckSpelling->setChecked(options->isSpellingCheckEnabled());
     ui->plainTextEdit->setSpellingCheckEnabled(options->isSpellingCheckEnabled());
     ui->actionYamlHeaderSupport->setChecked(options->isYamlHeaderSupportEnabled());
+    profiler->mark("options applied");
 
-    // set url to markdown syntax help
-    ui->webView_2->setUrl(tr("qrc:/syntax.html"));
+    // the markdown syntax help is loaded when it is shown the first time
+    connect(ui->dockWidget_2, SIGNAL(visibilityChanged(bool)),
+            this, SLOT(loadMarkdownSyntaxHelp()));
+    if (ui->dockWidget_2->isVisible()) {
+        loadMarkdownSyntaxHelp();
+    }
 
     // allow loading of remote javascript
     QWebSettings::globalSettings()->setAttribute(QWebSettings::LocalContentCanAccessRemoteUrls, true);
 
+    // the web inspector is created by the page on first use
     ui->webView->settings()->setAttribute(QWebSettings::DeveloperExtrasEnabled, true);
-    QWebInspector *inspector = new QWebInspector();
-    inspector->setPage(ui->webView->page());
 
-    ui->menuLanguages->loadDictionaries(options->dictionaryLanguage());
+    // searching the dictionaries is only needed for spell checking
+    // or when the user wants to choose another language
+    connect(ui->menuExtras, SIGNAL(aboutToShow()),
+            this, SLOT(loadDictionaries()));
+    if (options->isSpellingCheckEnabled()) {
+        loadDictionaries();
+    }
 
     //: path to built-in snippets resource.
     JsonFile<Snippet>::load(":/markdown-snippets.json", snippetCollection);
     QString path = DataLocation::writableLocation();
     JsonFile<Snippet>::load(path + "/user-snippets.json", snippetCollection);
+    profiler->mark("snippets loaded");
 
     // setup file explorer
     connect(ui->fileExplorerDockContents, SIGNAL(fileSelected(QString)),
@@ -190,9 +266,42 @@ void MainWindow::initializeApp()
     // load file passed to application on start
     if (!fileName.isEmpty()) {
         load(fileName);
+    } else {
+        recoverUntitledJournal();
+    }
+    profiler->mark("initialization finished");
+
+    if (profiler->isEnabled()) {
+        QTimer::singleShot(0, this, SLOT(startupFinished()));
+    }
+}
+
+void MainWindow::startupFinished()
+{
+    // the event loop is idle, so the editor accepts keystrokes
+    StartupProfiler::instance()->mark("ready for input");
+}
+
+void MainWindow::loadMarkdownSyntaxHelp()
+{
+    if (ui->webView_2->url().isEmpty() && ui->dockWidget_2->isVisible()) {
+        ui->webView_2->setUrl(tr("qrc:/syntax.html"));
+        StartupProfiler::instance()->mark("markdown syntax help loaded");
     }
 }
 
+void MainWindow::loadDictionaries()
+{
+    // no dictionaries found leaves the menu empty, so don't search again
+    if (dictionariesLoaded) {
+        return;
+    }
+    dictionariesLoaded = true;
+
+    ui->menuLanguages->loadDictionaries(options->dictionaryLanguage());
+    StartupProfiler::instance()->mark("dictionaries loaded");
+}
+
 void MainWindow::openRecentFile(const QString &fileName)
 {
     if (maybeSave()) {
@@ -209,11 +318,14 @@ void MainWindow::languageChanged(const Dictionary &dictionary)
 void MainWindow::fileNew()
 {
     if (maybeSave()) {
+        cancelLoading();
+        stopJournal();
         ui->plainTextEdit->clear();
         ui->plainTextEdit->resetHighlighting();
         ui->webView->setHtml(QString());
         ui->htmlSourceTextEdit->clear();
         setFileName(QString());
+        startJournal();
     }
 }
 
@@ -235,25 +347,14 @@ bool MainWindow::fileSave()
         return fileSaveAs();
     }
 
-    SaveFileAdapter file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
-    }
-
-    QTextDocumentWriter writer(&file, "plaintext");
-    bool success = writer.write(ui->plainTextEdit->document());
-    if (success) {
-        file.commit();
+    // encode and write a snapshot of the text in the background,
+    // the revision tells us later if it was edited in the meantime
+    QTextDocument *document = ui->plainTextEdit->document();
+    fileSaver->save(fileName, document->toPlainText(), document->revision());
 
-        // set status to unmodified
-        ui->plainTextEdit->document()->setModified(false);
-        setWindowModified(false);
-
-        // add to recent file list
-        recentFilesMenu->addFile(fileName);
-    }
-
-    return success;
+    // the save was started, its result is reported by fileSaved()
+    // and FileSaver::waitForSaved()
+    return true;
 }
 
 bool MainWindow::fileSaveAs()
@@ -269,10 +370,58 @@ bool MainWindow::fileSaveAs()
         name.append(".md");
     }
 
+    // the current journal keeps the changes until they are saved under the new name,
+    // it already contains the changes of an earlier unsuccessful save
+    if (previousJournal) {
+        previousJournal->discard();
+        delete previousJournal;
+    }
+    previousJournal = journal;
+    journal = 0;
+
     setFileName(name);
+
+    // the file is replaced by the document, so its journal is stale
+    const QString journalFileName = this->journalFileName();
+    if (AutosaveJournal::isOrphaned(journalFileName)) {
+        QFile::remove(journalFileName);
+    }
+    openJournal(journalFileName);
+
     return fileSave();
 }
 
+void MainWindow::fileSaved(const QString &fileName, int revision, bool success)
+{
+    // saved under a previous name?
+    bool currentFile = (fileName == this->fileName);
+
+    if (!success) {
+        if (currentFile) {
+            ui->plainTextEdit->document()->setModified(true);
+            setWindowModified(true);
+        }
+        statusBar()->showMessage(tr("Could not save %1").arg(QDir::toNativeSeparators(fileName)));
+        return;
+    }
+
+    // set status to unmodified if not edited during the save
+    if (currentFile && revision == ui->plainTextEdit->document()->revision()) {
+        ui->plainTextEdit->document()->setModified(false);
+        setWindowModified(false);
+    }
+
+    // the changes are safe under the new name now
+    if (currentFile && previousJournal) {
+        previousJournal->discard();
+        delete previousJournal;
+        previousJournal = 0;
+    }
+
+    // add to recent file list
+    recentFilesMenu->addFile(fileName);
+}
+
 void MainWindow::fileExportToHtml()
 {
     ExportHtmlDialog dialog(fileName);
@@ -280,22 +429,7 @@ void MainWindow::fileExportToHtml()
 
         QString cssStyle;
         if (dialog.includeCSS()) {
-            // get url of current css stylesheet
-            QUrl cssUrl = ui->webView->page()->settings()->userStyleSheetUrl();
-
-            // get resource or file name from url
-            QString cssFileName;
-            if (cssUrl.scheme() == "qrc") {
-                cssFileName = cssUrl.toString().remove(0, 3);
-            } else {
-                cssFileName = cssUrl.toLocalFile();
-            }
-
-            // read currently used css stylesheet file
-            QFile f(cssFileName);
-            if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                cssStyle = f.readAll();
-            }
+            cssStyle = currentStyleSheet();
         }
 
         QString highlightJs;
@@ -320,17 +454,154 @@ void MainWindow::fileExportToHtml()
 
 void MainWindow::fileExportToPdf()
 {
-    // using temporary QTextDocument instance to get links exported\printed correctly,
-    // as links will dissappear when printing directly from QWebView in current Qt implementation
-    // of QWebView::print() method (possible bug in Qt?)
+    // the PDF is laid out from the converter output with a QTextDocument
+    // instead of printing the QWebView, as links will dissappear when printing
+    // directly from QWebView in current Qt implementation of QWebView::print() method
+    // (possible bug in Qt?)
     // more info here: http://stackoverflow.com/questions/11629093/add-working-url-into-pdf-using-qt-qprinter
 
+    if (pdfExporter) {
+        return;
+    }
+
     ExportPdfDialog dialog(fileName);
     if (dialog.exec() == QDialog::Accepted) {
-         QTextDocument doc;
-         doc.setHtml(ui->webView->page()->currentFrame()->toHtml());
-         doc.print(dialog.printer());
+        HtmlPreviewGenerator *htmlGenerator = generator;
+        const QString styleSheet = currentStyleSheet();
+        const QUrl baseUrl = QUrl::fromLocalFile(QFileInfo(fileName).absolutePath() + QLatin1Char('/'));
+
+        // rendering, layout and printing run in the background
+        pdfExporter = new PdfExporter([htmlGenerator, styleSheet]() { return htmlGenerator->exportHtml(styleSheet, QString()); },
+                                      baseUrl, dialog.printer(), this);
+        connect(pdfExporter, SIGNAL(progressChanged(int,int)),
+                this, SLOT(pdfExportProgress(int,int)));
+        connect(pdfExporter, SIGNAL(exportFinished(bool)),
+                this, SLOT(pdfExportFinished(bool)));
+        pdfExporter->start();
+
+        ui->actionExportToPDF->setEnabled(false);
+        statusBar()->showMessage(tr("Exporting PDF..."));
+    }
+}
+
+void MainWindow::pdfExportProgress(int page, int pageCount)
+{
+    if (sender() != pdfExporter) {
+        return;
+    }
+
+    statusBar()->showMessage(tr("Exporting PDF (page %1 of %2)...").arg(page).arg(pageCount));
+}
+
+void MainWindow::pdfExportFinished(bool success)
+{
+    if (sender() != pdfExporter) {
+        return;
+    }
+
+    if (success) {
+        statusBar()->showMessage(tr("PDF exported"), 3000);
+    } else {
+        statusBar()->showMessage(tr("Error while exporting PDF"));
+    }
+
+    pdfExporter->wait();
+    pdfExporter->deleteLater();
+    pdfExporter = 0;
+
+    ui->actionExportToPDF->setEnabled(true);
+}
+
+void MainWindow::fileExportFolder()
+{
+    if (batchExporter) {
+        return;
+    }
+
+    const QString directory = fileName.isEmpty() ? QDir::homePath() : QFileInfo(fileName).absolutePath();
+
+    BatchExportDialog dialog(directory, this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    QStringList fileNames;
+    QDirIterator it(dialog.sourceDirectory(), QStringList() << "*.markdown" << "*.md" << "*.mdown",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        fileNames << it.next();
+    }
+    fileNames.sort();
+
+    if (fileNames.isEmpty()) {
+        statusBar()->showMessage(tr("No Markdown files found in %1").arg(QDir::toNativeSeparators(dialog.sourceDirectory())), 3000);
+        return;
+    }
+
+    // the shared assets are only loaded once for all documents
+    QString cssStyle;
+    if (dialog.includeCSS()) {
+        cssStyle = currentStyleSheet();
+    }
+
+    QString highlightJs;
+    if (dialog.includeCodeHighlighting()) {
+        QFile f(":/scripts/highlight.js/highlight.pack.js");
+        if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            highlightJs = f.readAll();
+        }
+    }
+
+    MarkdownConverter *converter = generator->createConverter();
+    const QString header = HighlightJsSupport::buildExportHeader(cssStyle, highlightJs, converter->templateRenderer()->codeHighlightingStyle());
+
+    batchExporter = new BatchExporter(converter, this);
+    batchExporter->setFiles(dialog.sourceDirectory(), fileNames);
+    batchExporter->setOutput(dialog.outputDirectory(),
+                             dialog.isPdfFormat() ? BatchExporter::PdfFormat : BatchExporter::HtmlFormat,
+                             dialog.isSingleBook());
+    batchExporter->setOptions(generator->converterOptions(), generator->renderOptions(), options->isYamlHeaderSupportEnabled());
+    batchExporter->setHeader(header);
+    connect(batchExporter, SIGNAL(progressChanged(int,int)),
+            this, SLOT(batchExportProgress(int,int)));
+    connect(batchExporter, SIGNAL(exportFinished(int,int,qint64,qint64)),
+            this, SLOT(batchExportFinished(int,int,qint64,qint64)));
+    batchExporter->start();
+
+    ui->actionExportFolder->setEnabled(false);
+    statusBar()->showMessage(tr("Exporting %n file(s)...", 0, fileNames.size()));
+}
+
+void MainWindow::batchExportProgress(int exported, int count)
+{
+    if (sender() != batchExporter) {
+        return;
+    }
+
+    statusBar()->showMessage(tr("Exporting files (%1 of %2)...").arg(exported).arg(count));
+}
+
+void MainWindow::batchExportFinished(int exported, int failed, qint64 bytes, qint64 milliseconds)
+{
+    if (sender() != batchExporter) {
+        return;
+    }
+
+    const double seconds = qMax<qint64>(milliseconds, 1) / 1000.0;
+    QString message = tr("Exported %n file(s) in %1 s (%2 files/s, %3 MB/s)", 0, exported)
+            .arg(seconds, 0, 'f', 1)
+            .arg(exported / seconds, 0, 'f', 1)
+            .arg(bytes / (1024.0 * 1024.0) / seconds, 0, 'f', 2);
+    if (failed > 0) {
+        message += tr(", %n file(s) failed", 0, failed);
     }
+    statusBar()->showMessage(message);
+
+    batchExporter->wait();
+    batchExporter->deleteLater();
+    batchExporter = 0;
+
+    ui->actionExportFolder->setEnabled(true);
 }
 
 void MainWindow::filePrint()
@@ -612,6 +883,10 @@ void MainWindow::extensionsSuperscript(bool enabled)
 
 void MainWindow::extrasCheckSpelling(bool checked)
 {
+    if (checked) {
+        loadDictionaries();
+    }
+
     ui->plainTextEdit->setSpellingCheckEnabled(checked);
     options->setSpellingCheckEnabled(checked);
 }
@@ -682,6 +957,20 @@ void MainWindow::helpMarkdownSyntax()
     ui->dockWidget_2->show();
 }
 
+void MainWindow::helpExportLatencyStatistics()
+{
+    QString name = QFileDialog::getSaveFileName(this, tr("Export Latency Statistics..."),
+                                                QString(), tr("JSON Files (*.json);;All Files (*)"));
+    if (name.isEmpty()) {
+        return;
+    }
+
+    if (!LatencyTracer::instance()->exportToFile(name)) {
+        QMessageBox::warning(this, QApplication::applicationDisplayName(),
+                             tr("Could not write to %1").arg(QDir::toNativeSeparators(name)));
+    }
+}
+
 void MainWindow::helpAbout()
 {
     AboutDialog dialog;
@@ -715,17 +1004,51 @@ void MainWindow::setHtmlSource(bool enabled)
 
 void MainWindow::plainTextChanged()
 {
+    TraceSpan span("MainWindow::plainTextChanged", "gui");
     QString code = ui->plainTextEdit->toPlainText();
 
+    QTextDocument *document = ui->plainTextEdit->document();
+    StallWatchdog::instance()->setDocumentState(code.length(), document->revision());
+    LatencyTracer::instance()->mark(document, document->revision(), LatencyTracer::PreviewRequested);
+
     // generate HTML from markdown
-    generator->markdownTextChanged(code);
+    generator->markdownTextChanged(code, document->revision());
 
     // show modification indicator in window title
     setWindowModified(ui->plainTextEdit->document()->isModified());
 }
 
-void MainWindow::htmlResultReady(const QString &html)
+void MainWindow::documentContentsChange(int position, int charsRemoved, int charsAdded)
 {
+    QTextDocument *document = ui->plainTextEdit->document();
+
+    // ignore format changes (e.g. by the syntax highlighter) and
+    // the chunks of a file that is still loading
+    if (!journal || fileLoader || document->revision() == journalRevision) {
+        return;
+    }
+    journalRevision = document->revision();
+
+    // only the changed part of the document is written to the journal
+    QTextCursor cursor(document);
+    cursor.setPosition(position);
+    cursor.setPosition(qMin(position + charsAdded, document->characterCount() - 1), QTextCursor::KeepAnchor);
+    QString addedText = cursor.selectedText().replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+
+    journal->recordChange(position, charsRemoved, addedText);
+
+    // replace the recorded changes with a snapshot once they are larger than
+    // the document, so the costs per change stay proportional to its size
+    if (journal->needsCompaction()) {
+        journal->compact(document->toPlainText());
+    }
+}
+
+void MainWindow::htmlResultReady(const QString &html, int revision)
+{
+    TraceSpan span("MainWindow::htmlResultReady", "gui");
+    LatencyTracer::instance()->mark(ui->plainTextEdit->document(), revision, LatencyTracer::PreviewReceived);
+
     // show html preview
     QUrl baseUrl;
     if (fileName.isEmpty()) {
@@ -736,11 +1059,23 @@ void MainWindow::htmlResultReady(const QString &html)
 
     QList<int> childSizes = ui->splitter->sizes();
     if (ui->webView->isVisible() && childSizes[1] != 0) {
+        previewRevision = revision;
         ui->webView->setHtml(html, baseUrl);
     }
 
     // show html source
-    ui->htmlSourceTextEdit->setPlainText(html);
+    {
+        TraceSpan span("MainWindow::updateHtmlSource", "gui");
+        ui->htmlSourceTextEdit->setPlainText(html);
+    }
+}
+
+void MainWindow::previewLoadFinished()
+{
+    if (previewRevision >= 0) {
+        LatencyTracer::instance()->mark(ui->plainTextEdit->document(), previewRevision, LatencyTracer::PreviewLoaded);
+        previewRevision = -1;
+    }
 }
 
 void MainWindow::tocResultReady(const QString &toc)
@@ -755,9 +1090,9 @@ void MainWindow::previewLinkClicked(const QUrl &url)
         if (QFileInfo(url.toLocalFile()).isDir()) return;
 
         QString filePath = url.toLocalFile();
-        // Links to markdown files open new instance
+        // Links to markdown files open new window
         if (filePath.endsWith(".md") || filePath.endsWith(".markdown") || filePath.endsWith(".mdown")) {
-            QProcess::startDetached(qApp->applicationFilePath(), QStringList() << filePath);
+            openInWindow(filePath);
             return;
         }
     }
@@ -789,6 +1124,9 @@ void MainWindow::addJavaScriptObject()
 {
     // add view synchronizer object to javascript engine
     ui->webView->page()->mainFrame()->addToJavaScriptWindowObject("synchronizer", viewSynchronizer);
+
+    // add cache for typeset formulas to javascript engine
+    ui->webView->page()->mainFrame()->addToJavaScriptWindowObject("fragmentCache", fragmentCache);
 }
 
 bool MainWindow::load(const QString &fileName)
@@ -803,12 +1141,34 @@ bool MainWindow::load(const QString &fileName)
         return false;
     }
 
-    // read content from file
-    QByteArray content = file.readAll();
-    QString text = QString::fromUtf8(content);
+    cancelLoading();
+    stopJournal();
 
-    ui->plainTextEdit->resetHighlighting();
-    ui->plainTextEdit->setPlainText(text);
+    if (file.size() > LARGE_FILE_SIZE) {
+        // load large files in the background to keep the UI responsive,
+        // highlighting and preview are updated once the file is loaded
+        ui->plainTextEdit->resetHighlighting();
+        ui->plainTextEdit->setHighlightingEnabled(false);
+        ui->plainTextEdit->clear();
+        ui->plainTextEdit->setReadOnly(true);
+        ui->plainTextEdit->document()->setUndoRedoEnabled(false);
+
+        fileLoader = new MarkdownFileLoader(fileName, ++loadGeneration, this);
+        connect(fileLoader, SIGNAL(chunkLoaded(int,QString,bool)),
+                this, SLOT(fileChunkLoaded(int,QString,bool)));
+        connect(fileLoader, SIGNAL(progressChanged(int,int)),
+                this, SLOT(fileLoadProgress(int,int)));
+        connect(fileLoader, SIGNAL(loadFinished(int,bool)),
+                this, SLOT(fileLoadFinished(int,bool)));
+        fileLoader->start();
+    } else {
+        // read content from file
+        QByteArray content = file.readAll();
+        QString text = QString::fromUtf8(content);
+
+        ui->plainTextEdit->resetHighlighting();
+        ui->plainTextEdit->setPlainText(text);
+    }
 
     // remember name of new file
     setFileName(fileName);
@@ -816,9 +1176,73 @@ bool MainWindow::load(const QString &fileName)
     // add to recent files
     recentFilesMenu->addFile(fileName);
 
+    // large files start journaling when completely loaded
+    if (!fileLoader) {
+        startJournal();
+    }
+
     return true;
 }
 
+void MainWindow::fileChunkLoaded(int generation, const QString &text, bool lastChunk)
+{
+    // ignore chunks of a canceled load, a new loader might
+    // have been created at the address of the canceled one
+    if (!fileLoader || generation != loadGeneration) {
+        return;
+    }
+
+    // only notify the preview, status bar etc. about the complete text.
+    // This blocks the editor's signals only: the document still reports
+    // every chunk, but the highlighter is disabled and the journal is
+    // stopped while loading, so its receivers do no real work.
+    ui->plainTextEdit->blockSignals(!lastChunk);
+
+    QTextCursor cursor(ui->plainTextEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    ui->plainTextEdit->blockSignals(false);
+
+    fileLoader->chunkProcessed();
+}
+
+void MainWindow::fileLoadProgress(int generation, int percent)
+{
+    if (!fileLoader || generation != loadGeneration) {
+        return;
+    }
+
+    statusBar()->showMessage(tr("Loading %1 (%2%)...").arg(QFileInfo(fileName).fileName()).arg(percent));
+}
+
+void MainWindow::fileLoadFinished(int generation, bool success)
+{
+    if (!fileLoader || generation != loadGeneration) {
+        return;
+    }
+
+    const QString loadedFileName = fileName;
+
+    cancelLoading();
+
+    if (success) {
+        statusBar()->clearMessage();
+
+        // set to unmodified
+        ui->plainTextEdit->document()->setModified(false);
+        setWindowModified(false);
+    } else {
+        // never leave a truncated document that could be saved over the file
+        ui->plainTextEdit->clear();
+        setFileName(QString());
+
+        statusBar()->showMessage(tr("Error while loading %1").arg(QDir::toNativeSeparators(loadedFileName)));
+    }
+
+    startJournal();
+}
+
 void MainWindow::proxyConfigurationChanged()
 {
     if (options->proxyMode() == Options::SystemProxy) {
@@ -860,7 +1284,7 @@ void MainWindow::markdownConverterChanged()
 #endif
     case Options::DiscountMarkdownConverter:
         viewSynchronizer = new HtmlViewSynchronizer(ui->webView, ui->plainTextEdit);
-        connect(generator, SIGNAL(htmlResultReady(QString)),
+        connect(generator, SIGNAL(htmlResultReady(QString,int)),
                 viewSynchronizer, SLOT(rememberScrollBarPos()));
         break;
     case Options::RevealMarkdownConverter:
@@ -905,6 +1329,13 @@ void MainWindow::setupUi()
     connect(options, &Options::editorStyleChanged,
             this, &MainWindow::editorStyleChanged);
 
+    // export of the keystroke to preview latencies
+    if (LatencyTracer::instance()->isEnabled()) {
+        QAction *action = ui->menuHelp->addAction(tr("Export Latency Statistics..."));
+        connect(action, SIGNAL(triggered()),
+                this, SLOT(helpExportLatencyStatistics()));
+    }
+
     readSettings();
     setupCustomShortcuts();
 
@@ -1051,6 +1482,10 @@ void MainWindow::setupMarkdownEditor()
     connect(ui->plainTextEdit, SIGNAL(loadDroppedFile(QString)),
             this, SLOT(load(QString)));
 
+    // record changes in the autosave journal
+    connect(ui->plainTextEdit->document(), SIGNAL(contentsChange(int,int,int)),
+            this, SLOT(documentContentsChange(int,int,int)));
+
     connect(options, &Options::editorFontChanged,
             ui->plainTextEdit, &MarkdownEditor::editorFontChanged);
     connect(options, &Options::tabWidthChanged,
@@ -1067,9 +1502,15 @@ void MainWindow::setupHtmlPreview()
     connect(ui->webView->page()->mainFrame(), SIGNAL(javaScriptWindowObjectCleared()),
             this, SLOT(addJavaScriptObject()));
 
+    // fragments rendered by the preview page are only used for this document
+    fragmentCache = new DocumentFragmentCache(generator->fragmentScopeId(), this);
+
     // start background HTML preview generator
-    connect(generator, SIGNAL(htmlResultReady(QString)),
-            this, SLOT(htmlResultReady(QString)));
+    generator->setSourceDocument(ui->plainTextEdit->document());
+    connect(generator, SIGNAL(htmlResultReady(QString,int)),
+            this, SLOT(htmlResultReady(QString,int)));
+    connect(ui->webView, SIGNAL(loadFinished(bool)),
+            this, SLOT(previewLoadFinished()));
     connect(generator, SIGNAL(tocResultReady(QString)),
             this, SLOT(tocResultReady(QString)));
     generator->start();
@@ -1131,6 +1572,9 @@ void MainWindow::syncWebViewToHtmlSource()
 
 bool MainWindow::maybeSave()
 {
+    if (fileLoader)
+        return true;
+
     if (!ui->plainTextEdit->document()->isModified())
         return true;
 
@@ -1144,13 +1588,128 @@ bool MainWindow::maybeSave()
                                QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
 
     if (ret == QMessageBox::Save)
-        return fileSave();
+        return fileSave() && fileSaver->waitForSaved(fileName);
     else if (ret == QMessageBox::Cancel)
         return false;
 
     return true;
 }
 
+void MainWindow::cancelLoading()
+{
+    if (!fileLoader) {
+        return;
+    }
+
+    fileLoader->cancel();
+    fileLoader->wait();
+    fileLoader->deleteLater();
+    fileLoader = 0;
+
+    ui->plainTextEdit->document()->setUndoRedoEnabled(true);
+    ui->plainTextEdit->setReadOnly(false);
+    ui->plainTextEdit->setHighlightingEnabled(true);
+}
+
+void MainWindow::startJournal()
+{
+    stopJournal();
+
+    QString journalFileName = this->journalFileName();
+    if (AutosaveJournal::isOrphaned(journalFileName)) {
+        recoverJournal(journalFileName);
+    }
+
+    openJournal(journalFileName);
+}
+
+void MainWindow::openJournal(const QString &journalFileName)
+{
+    journal = new AutosaveJournal(journalFileName, this);
+    if (!journal->start(ui->plainTextEdit->toPlainText())) {
+        delete journal;
+        journal = 0;
+    }
+
+    journalRevision = ui->plainTextEdit->document()->revision();
+}
+
+void MainWindow::stopJournal()
+{
+    // the document was saved or its changes were discarded
+    if (previousJournal) {
+        previousJournal->discard();
+        delete previousJournal;
+        previousJournal = 0;
+    }
+
+    if (!journal) {
+        return;
+    }
+
+    journal->discard();
+    delete journal;
+    journal = 0;
+}
+
+QString MainWindow::journalFileName()
+{
+    QString path = DataLocation::writableLocation() + QStringLiteral("/autosave");
+    QDir().mkpath(path);
+
+    QString name;
+    if (fileName.isEmpty()) {
+        if (untitledJournalName.isEmpty()) {
+            untitledJournalName = QStringLiteral("untitled-") + QUuid::createUuid().toString().mid(1, 36);
+        }
+        name = untitledJournalName;
+    } else {
+        QByteArray filePath = QFileInfo(fileName).absoluteFilePath().toUtf8();
+        name = QCryptographicHash::hash(filePath, QCryptographicHash::Sha1).toHex();
+    }
+
+    return path + QLatin1Char('/') + name + QStringLiteral(".journal");
+}
+
+void MainWindow::recoverJournal(const QString &journalFileName)
+{
+    QString text;
+    bool recovered = AutosaveJournal::recover(journalFileName, &text);
+
+    // changes of the crashed session have been saved?
+    if (recovered && text != ui->plainTextEdit->toPlainText()) {
+        QMessageBox::StandardButton ret;
+        ret = QMessageBox::question(this, tr("Recover Changes"),
+                                    tr("The document has unsaved changes from a previous session.<br>"
+                                       "Do you want to recover them?"),
+                                    QMessageBox::Yes | QMessageBox::No);
+
+        if (ret == QMessageBox::Yes) {
+            ui->plainTextEdit->setPlainText(text);
+            ui->plainTextEdit->document()->setModified(true);
+            setWindowModified(true);
+        }
+    }
+
+    QFile::remove(journalFileName);
+}
+
+void MainWindow::recoverUntitledJournal()
+{
+    QDir path(DataLocation::writableLocation() + QStringLiteral("/autosave"));
+    QStringList journals = path.entryList(QStringList() << QStringLiteral("untitled-*.journal"), QDir::Files, QDir::Time);
+
+    // continue with the journal of the crashed session
+    foreach (const QString &journal, journals) {
+        if (AutosaveJournal::isOrphaned(path.filePath(journal))) {
+            untitledJournalName = QFileInfo(journal).completeBaseName();
+            break;
+        }
+    }
+
+    startJournal();
+}
+
 void MainWindow::setFileName(const QString &fileName)
 {
     this->fileName = fileName;
@@ -1183,6 +1742,41 @@ void MainWindow::updateSplitter()
     ui->splitter->setSizes(childSizes);
 }
 
+void MainWindow::updateSchedulingState()
+{
+    DocumentScheduler::State state = DocumentScheduler::Background;
+    if (isMinimized()) {
+        state = DocumentScheduler::Suspended;
+    } else if (isActiveWindow()) {
+        state = DocumentScheduler::Foreground;
+    }
+
+    DocumentScheduler::instance()->setState(ui->plainTextEdit->document(), state);
+}
+
+void MainWindow::openInWindow(const QString &filePath)
+{
+    // file already open in one of our windows?
+    QString canonicalPath = QFileInfo(filePath).canonicalFilePath();
+    foreach (QWidget *widget, QApplication::topLevelWidgets()) {
+        MainWindow *window = qobject_cast<MainWindow*>(widget);
+        if (window && !window->fileName.isEmpty() &&
+            QFileInfo(window->fileName).canonicalFilePath() == canonicalPath) {
+            if (window->isMinimized()) {
+                window->showNormal();
+            }
+            window->activateWindow();
+            window->raise();
+            return;
+        }
+    }
+
+    // all windows share one process and one scheduler for their workers
+    MainWindow *window = new MainWindow(filePath);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->show();
+}
+
 void MainWindow::setupHtmlPreviewThemes()
 {
     ui->menuStyles->clear();
@@ -1275,3 +1869,25 @@ QString MainWindow::stylePath(const QString &styleName)
     QString suffix = options->isSourceAtSingleSizeEnabled() ? "" : "+";
     return QString(":/theme/%1%2.txt").arg(styleName).arg(suffix);
 }
+
+QString MainWindow::currentStyleSheet() const
+{
+    // get url of current css stylesheet
+    QUrl cssUrl = ui->webView->page()->settings()->userStyleSheetUrl();
+
+    // get resource or file name from url
+    QString cssFileName;
+    if (cssUrl.scheme() == "qrc") {
+        cssFileName = cssUrl.toString().remove(0, 3);
+    } else {
+        cssFileName = cssUrl.toLocalFile();
+    }
+
+    // read currently used css stylesheet file
+    QFile f(cssFileName);
+    if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return f.readAll();
+    }
+
+    return QString();
+}
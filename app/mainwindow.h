@@ -30,10 +30,16 @@ class QAction;
 class QActionGroup;
 class QLabel;
 class ActiveLabel;
+class AutosaveJournal;
+class BatchExporter;
 class Dictionary;
+class DocumentFragmentCache;
+class FileSaver;
 class HtmlPreviewController;
 class HtmlPreviewGenerator;
 class HtmlHighlighter;
+class MarkdownFileLoader;
+class PdfExporter;
 class RecentFilesMenu;
 class Options;
 class SlideLineMapping;
@@ -52,11 +58,15 @@ public:
     ~MainWindow();
 
 protected:
+    void changeEvent(QEvent *e) Q_DECL_OVERRIDE;
     void closeEvent(QCloseEvent *e) Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *e) Q_DECL_OVERRIDE;
 
 private slots:
     void initializeApp();
+    void startupFinished();
+    void loadMarkdownSyntaxHelp();
+    void loadDictionaries();
     void openRecentFile(const QString &fileName);
     void languageChanged(const Dictionary &dictionary);
 
@@ -64,8 +74,10 @@ private slots:
     void fileOpen();
     bool fileSave();
     bool fileSaveAs();
+    void fileSaved(const QString &fileName, int revision, bool success);
     void fileExportToHtml();
     void fileExportToPdf();
+    void fileExportFolder();
     void filePrint();
 
     void editUndo();
@@ -107,11 +119,14 @@ private slots:
 
     void helpMarkdownSyntax();
     void helpAbout();
+    void helpExportLatencyStatistics();
 
     void setHtmlSource(bool enabled);
 
     void plainTextChanged();
-    void htmlResultReady(const QString &html);
+    void documentContentsChange(int position, int charsRemoved, int charsAdded);
+    void htmlResultReady(const QString &html, int revision = -1);
+    void previewLoadFinished();
     void tocResultReady(const QString &toc);
 
     void previewLinkClicked(const QUrl &url);
@@ -121,6 +136,13 @@ private slots:
 
     void addJavaScriptObject();
     bool load(const QString &fileName);
+    void fileChunkLoaded(int generation, const QString &text, bool lastChunk);
+    void fileLoadProgress(int generation, int percent);
+    void fileLoadFinished(int generation, bool success);
+    void pdfExportProgress(int page, int pageCount);
+    void pdfExportFinished(bool success);
+    void batchExportProgress(int exported, int count);
+    void batchExportFinished(int exported, int failed, qint64 bytes, qint64 milliseconds);
     void proxyConfigurationChanged();
     void markdownConverterChanged();
 
@@ -138,8 +160,17 @@ private:
     void updateExtensionStatus();
     void syncWebViewToHtmlSource();
     bool maybeSave();
+    void cancelLoading();
+    void startJournal();
+    void openJournal(const QString &journalFileName);
+    void stopJournal();
+    QString journalFileName();
+    void recoverJournal(const QString &journalFileName);
+    void recoverUntitledJournal();
     void setFileName(const QString &fileName);
     void updateSplitter();
+    void updateSchedulingState();
+    void openInWindow(const QString &filePath);
     void setupHtmlPreviewThemes();
     void addSeparatorAfterBuiltInThemes();
     void loadCustomStyles();
@@ -147,6 +178,7 @@ private:
     void writeSettings();
     void applyCurrentTheme();
     QString stylePath(const QString &styleName);
+    QString currentStyleSheet() const;
 
 private:
     Ui::MainWindow *ui;
@@ -158,12 +190,24 @@ private:
     HtmlHighlighter *htmlHighlighter;
     SnippetCollection *snippetCollection;
     ViewSynchronizer *viewSynchronizer;
+    DocumentFragmentCache *fragmentCache;
     HtmlPreviewController *htmlPreviewController;
     ThemeCollection *themeCollection;
+    MarkdownFileLoader *fileLoader;
+    int loadGeneration;
+    FileSaver *fileSaver;
+    PdfExporter *pdfExporter;
+    BatchExporter *batchExporter;
+    AutosaveJournal *journal;
+    AutosaveJournal *previousJournal;
+    QString untitledJournalName;
+    int journalRevision;
+    int previewRevision;
     Theme currentTheme { "Default", "Default", "Default", "Default" };
     QString fileName;
     float splitFactor;
     bool rightViewCollapsed;
+    bool dictionariesLoaded;
 };
 
 #endif // MAINWINDOW_H
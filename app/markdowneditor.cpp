@@ -24,11 +24,11 @@
 #include <QShortcut>
 #include <QStyle>
 #include <QTextBlock>
-#include <QTextStream>
 
 #include <controls/linenumberarea.h>
-#include <peg-markdown-highlight/styleparser.h>
 #include <markdownhighlighter.h>
+#include <wordcounter.h>
+#include "editorstylecache.h"
 #include "markdownmanipulator.h"
 #include "snippetcompleter.h"
 
@@ -162,6 +162,16 @@ void MarkdownEditor::resetHighlighting()
     highlighter->reset();
 }
 
+void MarkdownEditor::setHighlightingEnabled(bool enabled)
+{
+    highlighter->setEnabled(enabled);
+
+    if (enabled) {
+        highlighter->reset();
+        highlighter->rehighlight();
+    }
+}
+
 void MarkdownEditor::paintEvent(QPaintEvent *e)
 {
     QPlainTextEdit::paintEvent(e);
@@ -370,59 +380,28 @@ bool MarkdownEditor::isUrlToLocalFile(const QMimeData *source) const
 
 void MarkdownEditor::loadStyleFromStylesheet(const QString &fileName)
 {
-    QFile f(fileName);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // the stylesheets are parsed only once per font
+    EditorStyle style;
+    if (!EditorStyleCache::instance()->find(fileName, font(), &style)) {
         return;
     }
 
-    QTextStream ts(&f);
-    QString input = ts.readAll();
-
-    // parse the stylesheet
-    PegMarkdownHighlight::StyleParser parser(input);
-    QVector<PegMarkdownHighlight::HighlightingStyle> styles = parser.highlightingStyles(this->font());
+    // set new style & restyle the visible part of the document first
+    highlighter->setStyles(style.highlightingStyles);
 
-    // set new style & rehighlight markdown document
-    highlighter->setStyles(styles);
-    highlighter->rehighlight();
+    int from = firstVisibleBlock().position();
+    QTextBlock lastVisibleBlock = cursorForPosition(viewport()->rect().bottomRight()).block();
+    int to = lastVisibleBlock.position() + lastVisibleBlock.length();
+    highlighter->restyle(from, to);
 
     // update color palette
-    this->setPalette(parser.editorPalette());
+    this->setPalette(style.palette);
     this->viewport()->setPalette(this->palette());
 }
 
 int MarkdownEditor::countWords() const
 {
-    QString text = toPlainText();
-
-    // empty or only whitespaces?
-    if (text.trimmed().isEmpty()) {
-        return 0;
-    }
-
-    int words = 0;
-    bool lastWasWhitespace = false;
-    bool firstCharacter = false;
-
-    for (int i = 0; i < text.count(); ++i) {
-        if (text.at(i).isSpace()) {
-            if (firstCharacter && !lastWasWhitespace) {
-                words++;
-            }
-            lastWasWhitespace = true;
-        }
-        else
-        {
-            firstCharacter = true;
-            lastWasWhitespace = false;
-        }
-    }
-
-    if (!lastWasWhitespace && text.count() > 0) {
-        words++;
-    }
-
-    return words;
+    return WordCounter::countWords(toPlainText());
 }
 
 void MarkdownEditor::setShowSpecialCharacters(bool enabled)
@@ -559,39 +538,7 @@ QString MarkdownEditor::textUnderCursor() const
     return cursor.selectedText();
 }
 
-bool GreaterThanMinimumWordLength(const QString &word)
-{
-    static const int MINIMUM_WORD_LENGTH = 3;
-    return word.length() > MINIMUM_WORD_LENGTH;
-}
-
 QStringList MarkdownEditor::extractDistinctWordsFromDocument() const
 {
-    QStringList allWords = retrieveAllWordsFromDocument();
-    allWords.removeDuplicates();
-
-    QStringList words = filterWordList(allWords, GreaterThanMinimumWordLength);
-    words.sort(Qt::CaseInsensitive);
-
-    return words;
-}
-
-QStringList MarkdownEditor::retrieveAllWordsFromDocument() const
-{
-    return toPlainText().split(QRegExp("\\W+"), QString::SkipEmptyParts);
-}
-
-template <class UnaryPredicate>
-QStringList MarkdownEditor::filterWordList(const QStringList &words, UnaryPredicate predicate) const
-{
-    QStringList filteredWordList;
-
-    foreach (const QString &word, words) {
-        if (predicate(word))
-        {
-           filteredWordList << word;
-        }
-    }
-
-    return filteredWordList;
+    return WordCounter::distinctWords(toPlainText());
 }
@@ -38,6 +38,7 @@ public:
     int lineNumberAreaWidth();
 
     void resetHighlighting();
+    void setHighlightingEnabled(bool enabled);
     void loadStyleFromStylesheet(const QString &fileName);
 
     int countWords() const;
@@ -82,10 +83,7 @@ private:
     void drawLineEndMarker(QPaintEvent *e);
     void drawRuler(QPaintEvent *e);
     QString textUnderCursor() const;
-    QStringList extractDistinctWordsFromDocument() const;    
-    QStringList retrieveAllWordsFromDocument() const;
-    template <class UnaryPredicate>
-    QStringList filterWordList(const QStringList &words, UnaryPredicate predicate) const;
+    QStringList extractDistinctWordsFromDocument() const;
 
 private:
     QWidget *lineNumberArea;
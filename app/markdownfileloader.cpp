@@ -0,0 +1,133 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "markdownfileloader.h"
+
+#include <QFile>
+#include <QScopedPointer>
+#include <QTextCodec>
+#include <QTextDecoder>
+
+static const qint64 CHUNK_SIZE = 1024 * 1024;
+static const int MAXIMUM_PENDING_CHUNKS = 4;
+
+
+MarkdownFileLoader::MarkdownFileLoader(const QString &fileName, int generation, QObject *parent) :
+    QThread(parent),
+    fileName(fileName),
+    generation(generation),
+    freeChunks(MAXIMUM_PENDING_CHUNKS),
+    cancelled(0)
+{
+}
+
+void MarkdownFileLoader::chunkProcessed()
+{
+    freeChunks.release();
+}
+
+void MarkdownFileLoader::cancel()
+{
+    cancelled.store(1);
+
+    // wake up the thread if it waits for the GUI
+    freeChunks.release(MAXIMUM_PENDING_CHUNKS);
+}
+
+void MarkdownFileLoader::run()
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit loadFinished(generation, false);
+        return;
+    }
+
+    const qint64 size = file.size();
+
+    // map the file into memory to avoid a copy of the raw data
+    // (or read it chunk by chunk if mapping is not possible)
+    uchar *data = size > 0 ? file.map(0, size) : 0;
+
+    // the decoder keeps UTF-8 sequences that are split between two chunks
+    QScopedPointer<QTextDecoder> decoder(QTextCodec::codecForName("UTF-8")->makeDecoder());
+
+    bool success = true;
+    QString pendingChunk;
+    QString carry;
+    qint64 offset = 0;
+
+    while (offset < size && !cancelled.load()) {
+        QString text;
+        if (data) {
+            const int length = qMin(CHUNK_SIZE, size - offset);
+            text = decoder->toUnicode(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+        } else {
+            QByteArray buffer = file.read(CHUNK_SIZE);
+            if (buffer.isEmpty()) {
+                success = false;
+                break;
+            }
+            text = decoder->toUnicode(buffer);
+            offset += buffer.size();
+        }
+
+        // convert line endings like QIODevice::Text does, a CRLF
+        // might also be split between two chunks
+        text.prepend(carry);
+        carry.clear();
+        if (offset < size && text.endsWith(QLatin1Char('\r'))) {
+            text.chop(1);
+            carry = QStringLiteral("\r");
+        }
+        text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+
+        // hold back one chunk, so we know which one is the last
+        if (!text.isEmpty()) {
+            if (!pendingChunk.isEmpty()) {
+                emitChunk(pendingChunk, false);
+            }
+            pendingChunk = text;
+        }
+
+        emit progressChanged(generation, int(offset * 100 / size));
+    }
+
+    if (data) {
+        file.unmap(data);
+    }
+
+    if (cancelled.load()) {
+        return;
+    }
+
+    pendingChunk += carry;
+    if (!pendingChunk.isEmpty()) {
+        emitChunk(pendingChunk, true);
+    }
+
+    emit loadFinished(generation, success);
+}
+
+void MarkdownFileLoader::emitChunk(const QString &text, bool lastChunk)
+{
+    // don't decode more of the file than the GUI is able to insert
+    freeChunks.acquire();
+
+    if (!cancelled.load()) {
+        emit chunkLoaded(generation, text, lastChunk);
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MARKDOWNFILELOADER_H
+#define MARKDOWNFILELOADER_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthread.h>
+
+
+// Every signal carries the generation of the load, so the receiver
+// can tell the signals of a canceled load from the current one.
+class MarkdownFileLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    MarkdownFileLoader(const QString &fileName, int generation, QObject *parent = 0);
+
+    void chunkProcessed();
+    void cancel();
+
+signals:
+    void chunkLoaded(int generation, const QString &text, bool lastChunk);
+    void progressChanged(int generation, int percent);
+    void loadFinished(int generation, bool success);
+
+protected:
+    virtual void run();
+
+private:
+    void emitChunk(const QString &text, bool lastChunk);
+
+private:
+    QString fileName;
+    int generation;
+    QSemaphore freeChunks;
+    QAtomicInt cancelled;
+};
+
+#endif // MARKDOWNFILELOADER_H
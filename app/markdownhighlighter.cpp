@@ -21,8 +21,11 @@
 #include <QFile>
 #include <QTextDocument>
 #include <QTextLayout>
+#include <QTimer>
 
+#include "latencytracer.h"
 #include "pmh_parser.h"
+#include "tracerecorder.h"
 #include "yamlheaderchecker.h"
 
 #include "peg-markdown-highlight/definitions.h"
@@ -33,9 +36,21 @@ using hunspell::SpellChecker;
 
 #include <QDebug>
 
+// the rest of the document is restyled in slices of this many
+// characters per event loop iteration to keep the editor responsive
+static const int RESTYLE_SLICE_SIZE = 128 * 1024;
+
+
 MarkdownHighlighter::MarkdownHighlighter(QTextDocument *document, hunspell::SpellChecker *spellChecker) :
     QSyntaxHighlighter(document),
     workerThread(new HighlightWorkerThread(this)),
+    elements(0),
+    elementsOffset(0),
+    requestedRevision(0),
+    restylePosition(0),
+    enabled(true),
+    parseScheduled(false),
+    restyleScheduled(false),
     spellingCheckEnabled(false),
     yamlHeaderSupportEnabled(false)
 {
@@ -45,8 +60,9 @@ MarkdownHighlighter::MarkdownHighlighter(QTextDocument *document, hunspell::Spel
     spellFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
     spellFormat.setUnderlineColor(Qt::red);
 
-    connect(workerThread, SIGNAL(resultReady(pmh_element**, unsigned long)),
-            this, SLOT(resultReady(pmh_element**, unsigned long)));
+    workerThread->setSourceDocument(document);
+    connect(workerThread, SIGNAL(resultReady(pmh_element**, unsigned long, int)),
+            this, SLOT(resultReady(pmh_element**, unsigned long, int)));
     workerThread->start();
 }
 
@@ -56,6 +72,10 @@ MarkdownHighlighter::~MarkdownHighlighter()
     workerThread->enqueue(QString());
     workerThread->wait();
     delete workerThread;
+
+    if (elements) {
+        pmh_free_elements(elements);
+    }
 }
 
 void MarkdownHighlighter::reset()
@@ -63,10 +83,34 @@ void MarkdownHighlighter::reset()
     previousText.clear();
 }
 
+void MarkdownHighlighter::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+}
+
 void MarkdownHighlighter::setStyles(const QVector<PegMarkdownHighlight::HighlightingStyle> &styles)
 {
     highlightingStyles = styles;
-    reset();
+}
+
+void MarkdownHighlighter::restyle(int from, int to)
+{
+    // nothing parsed yet, so there is nothing to restyle
+    if (!elements) {
+        reset();
+        rehighlight();
+        return;
+    }
+
+    // apply the new styles to the elements of the last parse
+    // and restyle the rest of the document afterwards
+    applyElements(from, to);
+
+    restylePosition = 0;
+    if (!restyleScheduled) {
+        restyleScheduled = true;
+        QTimer::singleShot(0, this, SLOT(restyleDocument()));
+    }
 }
 
 void MarkdownHighlighter::setSpellingCheckEnabled(bool enabled)
@@ -81,7 +125,9 @@ void MarkdownHighlighter::setYamlHeaderSupportEnabled(bool enabled)
 
 void MarkdownHighlighter::highlightBlock(const QString &textBlock)
 {
-    if (document()->isEmpty()) {
+    TraceSpan span("MarkdownHighlighter::highlightBlock", "gui");
+
+    if (!enabled || document()->isEmpty()) {
         return;
     }
 
@@ -90,6 +136,23 @@ void MarkdownHighlighter::highlightBlock(const QString &textBlock)
         checkSpelling(textBlock);
     }
 
+    // parse the whole document only once after all
+    // changed blocks have been highlighted
+    if (!parseScheduled) {
+        parseScheduled = true;
+        QTimer::singleShot(0, this, SLOT(parseDocument()));
+    }
+}
+
+void MarkdownHighlighter::parseDocument()
+{
+    TraceSpan span("MarkdownHighlighter::parseDocument", "gui");
+    parseScheduled = false;
+
+    if (!enabled || document()->isEmpty()) {
+        return;
+    }
+
     QString text = document()->toPlainText();
 
     // document changed since last call?
@@ -108,11 +171,34 @@ void MarkdownHighlighter::highlightBlock(const QString &textBlock)
         actualText = text;
     }
 
-    workerThread->enqueue(actualText, offset);
+    const int revision = document()->revision();
+    LatencyTracer::instance()->mark(document(), revision, LatencyTracer::HighlightRequested);
+
+    workerThread->enqueue(actualText, offset, revision);
+    requestedRevision = revision;
 
     previousText = text;
 }
 
+void MarkdownHighlighter::restyleDocument()
+{
+    TraceSpan span("MarkdownHighlighter::restyleDocument", "gui");
+    restyleScheduled = false;
+
+    if (!elements) {
+        return;
+    }
+
+    const int end = qMin(restylePosition + RESTYLE_SLICE_SIZE, document()->characterCount());
+    applyElements(restylePosition, end);
+    restylePosition = end;
+
+    if (restylePosition < document()->characterCount()) {
+        restyleScheduled = true;
+        QTimer::singleShot(0, this, SLOT(restyleDocument()));
+    }
+}
+
 void MarkdownHighlighter::applyFormat(unsigned long pos, unsigned long end,
                                       QTextCharFormat format, bool merge)
 {
@@ -169,6 +255,8 @@ void MarkdownHighlighter::applyFormat(unsigned long pos, unsigned long end,
 
 void MarkdownHighlighter::checkSpelling(const QString &textBlock)
 {
+    TraceSpan span("MarkdownHighlighter::checkSpelling", "gui");
+
     QStringList wordList = textBlock.split(QRegExp("\\W+"), QString::SkipEmptyParts);
     int index = 0;
     foreach (QString word, wordList) {
@@ -181,25 +269,70 @@ void MarkdownHighlighter::checkSpelling(const QString &textBlock)
     }
 }
 
-void MarkdownHighlighter::resultReady(pmh_element **elements, unsigned long base_offset)
+void MarkdownHighlighter::resultReady(pmh_element **elements, unsigned long base_offset, int revision)
 {
+    TraceSpan span("MarkdownHighlighter::resultReady", "gui");
+
     if (!elements) {
         qDebug() << "elements is null";
         return;
     }
 
+    // a newer parse is on its way
+    if (revision != requestedRevision) {
+        pmh_free_elements(elements);
+        return;
+    }
+
     // clear any format before base_offset
     if (base_offset > 0) {
         applyFormat(0, base_offset - 1, QTextCharFormat(), false);
     }
 
-    // apply highlight results
+    // keep the elements to be able to restyle without parsing
+    if (this->elements) {
+        pmh_free_elements(this->elements);
+    }
+    this->elements = elements;
+    elementsOffset = base_offset;
+
+    // apply highlight results, this also finishes a pending restyle
+    applyHighlighting(0, document()->characterCount());
+    restylePosition = document()->characterCount();
+
+    // mark complete document as dirty
+    document()->markContentsDirty(0, document()->characterCount());
+
+    LatencyTracer::instance()->mark(document(), revision, LatencyTracer::HighlightApplied);
+}
+
+void MarkdownHighlighter::applyElements(int from, int to)
+{
+    to = qMin(to, document()->characterCount());
+    if (to <= from) {
+        return;
+    }
+
+    clearHighlighting(from, to);
+    applyHighlighting(from, to);
+
+    document()->markContentsDirty(from, to - from);
+}
+
+void MarkdownHighlighter::applyHighlighting(unsigned long from, unsigned long to)
+{
     for (int i = 0; i < highlightingStyles.size(); i++) {
         HighlightingStyle style = highlightingStyles.at(i);
         pmh_element *elem_cursor = elements[style.type];
         while (elem_cursor != NULL) {
-            unsigned long pos = elem_cursor->pos + base_offset;
-            unsigned long end = elem_cursor->end + base_offset;
+            unsigned long pos = elem_cursor->pos + elementsOffset;
+            unsigned long end = elem_cursor->end + elementsOffset;
+
+            // skip elements outside of the range
+            if (end <= from || pos >= to) {
+                elem_cursor = elem_cursor->next;
+                continue;
+            }
 
             QTextCharFormat format = style.format;
             if (/*_makeLinksClickable
@@ -216,15 +349,29 @@ void MarkdownHighlighter::resultReady(pmh_element **elements, unsigned long base
                 format.setAnchorHref(address);
                 format.setToolTip(address);
             }
-            applyFormat(pos, end, format, true);
+            applyFormat(qMax(pos, from), qMin(end, to), format, true);
 
             elem_cursor = elem_cursor->next;
         }
     }
+}
 
-    // mark complete document as dirty
-    document()->markContentsDirty(0, document()->characterCount());
+void MarkdownHighlighter::clearHighlighting(int from, int to)
+{
+    // remove the highlighting of the old style, but
+    // keep the marks of the spell checker
+    QTextBlock block = document()->findBlock(from);
+    while (block.isValid() && block.position() < to) {
+        QTextLayout *layout = block.layout();
+
+        QList<QTextLayout::FormatRange> list;
+        foreach (const QTextLayout::FormatRange &range, layout->additionalFormats()) {
+            if (range.format == spellFormat) {
+                list.append(range);
+            }
+        }
+        layout->setAdditionalFormats(list);
 
-    // free highlighting elements
-    pmh_free_elements(elements);
+        block = block.next();
+    }
 }
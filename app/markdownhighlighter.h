@@ -36,7 +36,9 @@ public:
     ~MarkdownHighlighter();
     
     void reset();
+    void setEnabled(bool enabled);
     void setStyles(const QVector<PegMarkdownHighlight::HighlightingStyle> &styles);
+    void restyle(int from, int to);
     void setSpellingCheckEnabled(bool enabled);
     void setYamlHeaderSupportEnabled(bool enabled);
 
@@ -44,17 +46,29 @@ protected:
     void highlightBlock(const QString &textBlock) Q_DECL_OVERRIDE;
 
 private slots:
-    void resultReady(pmh_element **elements, unsigned long base_offset);
+    void parseDocument();
+    void restyleDocument();
+    void resultReady(pmh_element **elements, unsigned long base_offset, int revision);
 
 private:
     void applyFormat(unsigned long pos, unsigned long end, QTextCharFormat format, bool merge);
+    void applyElements(int from, int to);
+    void applyHighlighting(unsigned long from, unsigned long to);
+    void clearHighlighting(int from, int to);
     void checkSpelling(const QString &textBlock);
 
     HighlightWorkerThread *workerThread;
     QVector<PegMarkdownHighlight::HighlightingStyle> highlightingStyles;
+    pmh_element **elements;
+    unsigned long elementsOffset;
+    int requestedRevision;
+    int restylePosition;
     QString previousText;
     QTextCharFormat spellFormat;
     hunspell::SpellChecker *spellChecker;
+    bool enabled;
+    bool parseScheduled;
+    bool restyleScheduled;
     bool spellingCheckEnabled;
     bool yamlHeaderSupportEnabled;
 };
@@ -57,6 +57,7 @@ static const char* SPELLINGCHECK_ENABLED = "spelling/enabled";
 static const char* DICTIONARY_LANGUAGE = "spelling/language";
 static const char* YAMLHEADERSUPPORT_ENABLED = "yamlheadersupport/enabled";
 static const char* DIAGRAMSUPPORT_ENABLED = "diagramsupport/enabled";
+static const char* PARALLELRENDERING_ENABLED = "preview/parallelrendering";
 
 static const char* DEPRECATED__LAST_USED_STYLE = "general/lastusedstyle";
 
@@ -80,6 +81,7 @@ Options::Options(QObject *parent) :
     m_sourceAtSingleSizeEnabled(true),
     m_spellingCheckEnabled(true),
     m_diagramSupportEnabled(false),
+    m_parallelRenderingEnabled(false),
     m_lineColumnEnabled(true),
     m_rulerEnabled(false),
     m_rulerPos(80),
@@ -447,6 +449,16 @@ void Options::setDiagramSupportEnabled(bool enabled)
     m_diagramSupportEnabled = enabled;
 }
 
+bool Options::isParallelRenderingEnabled() const
+{
+    return m_parallelRenderingEnabled;
+}
+
+void Options::setParallelRenderingEnabled(bool enabled)
+{
+    m_parallelRenderingEnabled = enabled;
+}
+
 QString Options::dictionaryLanguage() const
 {
     return m_dictionaryLanguage;
@@ -543,6 +555,9 @@ void Options::readSettings()
     m_yamlHeaderSupportEnabled = settings.value(YAMLHEADERSUPPORT_ENABLED, false).toBool();
     m_diagramSupportEnabled = settings.value(DIAGRAMSUPPORT_ENABLED, false).toBool();
 
+    // experimental: render large documents in parallel chunks
+    m_parallelRenderingEnabled = settings.value(PARALLELRENDERING_ENABLED, false).toBool();
+
     // spelling check settings
     m_spellingCheckEnabled = settings.value(SPELLINGCHECK_ENABLED, true).toBool();
     m_dictionaryLanguage = settings.value(DICTIONARY_LANGUAGE, "en_US").toString();
@@ -612,6 +627,7 @@ void Options::writeSettings()
     settings.setValue(SOURCEATSINGLESIZE_ENABLED, m_sourceAtSingleSizeEnabled);
     settings.setValue(YAMLHEADERSUPPORT_ENABLED, m_yamlHeaderSupportEnabled);
     settings.setValue(DIAGRAMSUPPORT_ENABLED, m_diagramSupportEnabled);
+    settings.setValue(PARALLELRENDERING_ENABLED, m_parallelRenderingEnabled);
 
     // spelling check settings
     settings.setValue(SPELLINGCHECK_ENABLED, m_spellingCheckEnabled);
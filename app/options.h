@@ -143,6 +143,9 @@ public:
     bool isDiagramSupportEnabled() const;
     void setDiagramSupportEnabled(bool enabled);
 
+    bool isParallelRenderingEnabled() const;
+    void setParallelRenderingEnabled(bool enabled);
+
     QString dictionaryLanguage() const;
     void setDictionaryLanguage(const QString &language);
 
@@ -193,6 +196,7 @@ private:
     bool m_spellingCheckEnabled;
     bool m_yamlHeaderSupportEnabled;
     bool m_diagramSupportEnabled;
+    bool m_parallelRenderingEnabled;
     bool m_lineColumnEnabled;
     bool m_rulerEnabled;
     int m_rulerPos;
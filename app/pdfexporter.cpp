@@ -0,0 +1,112 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "pdfexporter.h"
+
+#include <QAbstractTextDocumentLayout>
+#include <QFile>
+#include <QPainter>
+#include <QPrinter>
+#include <QTextDocument>
+#include <QTextFrame>
+
+
+PdfExporter::PdfExporter(const HtmlSource &htmlSource, const QUrl &baseUrl, QPrinter *printer, QObject *parent) :
+    QThread(parent),
+    htmlSource(htmlSource),
+    baseUrl(baseUrl),
+    printer(printer),
+    cancelled(0)
+{
+}
+
+PdfExporter::~PdfExporter()
+{
+    cancel();
+    wait();
+}
+
+void PdfExporter::cancel()
+{
+    cancelled.store(1);
+}
+
+void PdfExporter::run()
+{
+    const bool success = printDocument(htmlSource(), baseUrl, printer.data(), cancelled,
+                                       [this](int page, int pageCount) { emit progressChanged(page, pageCount); });
+
+    emit exportFinished(success);
+}
+
+bool PdfExporter::printDocument(const QString &html, const QUrl &baseUrl, QPrinter *printer,
+                                const QAtomicInt &cancelled, const ProgressCallback &progress)
+{
+    QPainter painter;
+    if (!painter.begin(printer)) {
+        return false;
+    }
+
+    // lay out the document directly for the printer resolution
+    // instead of scaling a layout made for the screen
+    QTextDocument document;
+    document.documentLayout()->setPaintDevice(printer);
+    document.setBaseUrl(baseUrl);
+    document.setHtml(html);
+
+    // same 2 cm margins as QTextDocument::print()
+    const int margin = int((2 / 2.54) * printer->logicalDpiY());
+    QTextFrameFormat format = document.rootFrame()->frameFormat();
+    format.setMargin(margin);
+    document.rootFrame()->setFrameFormat(format);
+
+    const QSizeF pageSize(printer->width(), printer->height());
+    document.setPageSize(pageSize);
+
+    bool aborted = false;
+    const int pageCount = document.pageCount();
+    for (int page = 0; page < pageCount; ++page) {
+        if (cancelled.load() || (page > 0 && !printer->newPage())) {
+            aborted = true;
+            break;
+        }
+
+        const QRectF view(0, page * pageSize.height(), pageSize.width(), pageSize.height());
+
+        painter.save();
+        painter.translate(0, -view.top());
+        painter.setClipRect(view);
+
+        QAbstractTextDocumentLayout::PaintContext context;
+        context.clip = view;
+        document.documentLayout()->draw(&painter, context);
+
+        painter.restore();
+
+        if (progress) {
+            progress(page + 1, pageCount);
+        }
+    }
+
+    const bool success = painter.end() && !aborted;
+
+    // don't leave an incomplete file behind
+    if (!success) {
+        QFile::remove(printer->outputFileName());
+    }
+
+    return success;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PDFEXPORTER_H
+#define PDFEXPORTER_H
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qurl.h>
+
+#include <functional>
+
+class QPrinter;
+
+
+// Generates the exported HTML, lays it out and prints it page by page
+// to a PDF file in a background thread. Every finished page is written
+// to the file, so only the layout of the document is kept in memory.
+class PdfExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QString ()> HtmlSource;
+
+    // takes ownership of the printer, the HTML source is called
+    // in the background thread
+    PdfExporter(const HtmlSource &htmlSource, const QUrl &baseUrl, QPrinter *printer, QObject *parent = 0);
+    ~PdfExporter();
+
+    void cancel();
+
+    typedef std::function<void (int page, int pageCount)> ProgressCallback;
+    static bool printDocument(const QString &html, const QUrl &baseUrl, QPrinter *printer,
+                              const QAtomicInt &cancelled, const ProgressCallback &progress = ProgressCallback());
+
+signals:
+    void progressChanged(int page, int pageCount);
+    void exportFinished(bool success);
+
+protected:
+    virtual void run();
+
+private:
+    HtmlSource htmlSource;
+    QUrl baseUrl;
+    QScopedPointer<QPrinter> printer;
+    QAtomicInt cancelled;
+};
+
+#endif // PDFEXPORTER_H
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "startupprofiler.h"
+
+#include <QDebug>
+
+
+StartupProfiler::StartupProfiler() :
+    enabled(false)
+{
+    timer.start();
+}
+
+StartupProfiler *StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return &profiler;
+}
+
+void StartupProfiler::setEnabled(bool enabled)
+{
+    if (enabled == this->enabled) {
+        return;
+    }
+
+    this->enabled = enabled;
+
+    // print the phases recorded before profiling was enabled
+    if (enabled) {
+        qint64 previous = 0;
+        for (int i = 0; i < phases.count(); ++i) {
+            print(phases.at(i).first, phases.at(i).second, phases.at(i).second - previous);
+            previous = phases.at(i).second;
+        }
+    }
+}
+
+bool StartupProfiler::isEnabled() const
+{
+    return enabled;
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+    const qint64 elapsed = timer.elapsed();
+    const qint64 previous = phases.isEmpty() ? 0 : phases.last().second;
+    phases.append(qMakePair(phase, elapsed));
+
+    if (enabled) {
+        print(phase, elapsed, elapsed - previous);
+    }
+}
+
+void StartupProfiler::print(const QString &phase, qint64 elapsed, qint64 delta) const
+{
+    qDebug().noquote() << QString("startup: %1 ms (+%2 ms) %3")
+                          .arg(elapsed, 6).arg(delta, 4).arg(phase);
+}
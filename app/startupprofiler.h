@@ -0,0 +1,49 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qstring.h>
+
+
+// Records the time of the startup phases since the start of the
+// process. The phases are printed if profiling is enabled with
+// the --profile-startup command line option.
+class StartupProfiler
+{
+public:
+    static StartupProfiler *instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void mark(const QString &phase);
+
+private:
+    StartupProfiler();
+
+    void print(const QString &phase, qint64 elapsed, qint64 delta) const;
+
+    QElapsedTimer timer;
+    QList<QPair<QString, qint64> > phases;
+    bool enabled;
+};
+
+#endif // STARTUPPROFILER_H
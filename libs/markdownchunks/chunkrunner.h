@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CHUNKRUNNER_H
+#define CHUNKRUNNER_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <functional>
+
+
+// Calls a function for every chunk of a document on the global thread
+// pool and waits for all of them. The first chunk is handled by the
+// calling thread.
+class ChunkRunner
+{
+public:
+    static void run(int count, const std::function<void(int)> &function);
+
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(const std::function<void(int)> &function, int index, QSemaphore *finished) :
+            function(function),
+            index(index),
+            finished(finished)
+        {
+        }
+
+        void run() Q_DECL_OVERRIDE
+        {
+            function(index);
+            finished->release();
+        }
+
+    private:
+        const std::function<void(int)> &function;
+        int index;
+        QSemaphore *finished;
+    };
+
+    ChunkRunner();
+};
+
+inline void ChunkRunner::run(int count, const std::function<void(int)> &function)
+{
+    QSemaphore finished;
+    for (int i = 1; i < count; ++i) {
+        QThreadPool::globalInstance()->start(new Task(function, i, &finished));
+    }
+    if (count > 0) {
+        function(0);
+    }
+    finished.acquire(qMax(0, count - 1));
+}
+
+#endif // CHUNKRUNNER_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MARKDOWNBLOCKSCANNER_H
+#define MARKDOWNBLOCKSCANNER_H
+
+#include <QString>
+
+
+// Follows the block structure of Markdown text line by line, as far
+// as needed to tell where a new block starts that nothing above can
+// continue into. Used to cut documents into independent parts.
+class MarkdownBlockScanner
+{
+public:
+    MarkdownBlockScanner();
+
+    // a paragraph or header that starts a new, independent block
+    bool isChunkBoundary(const QStringRef &line) const;
+
+    // any block outside of code, HTML and an open block quote
+    bool isBlockStart(const QStringRef &line) const;
+
+    bool isInsideCodeOrHtml() const;
+
+    void addLine(const QStringRef &line);
+
+    static bool isIndented(const QStringRef &line);
+    static bool isCodeFence(const QStringRef &line);
+    static bool isListItem(const QStringRef &line);
+    static bool startsTopLevelBlock(const QStringRef &line);
+    static int htmlDepthChange(const QStringRef &line);
+
+private:
+    bool previousLineBlank;
+    bool insideCodeFence;
+    bool insideHtmlComment;
+    bool insideBlockQuote;
+    int htmlDepth;
+};
+
+inline MarkdownBlockScanner::MarkdownBlockScanner() :
+    previousLineBlank(true),
+    insideCodeFence(false),
+    insideHtmlComment(false),
+    insideBlockQuote(false),
+    htmlDepth(0)
+{
+}
+
+inline bool MarkdownBlockScanner::isChunkBoundary(const QStringRef &line) const
+{
+    return isBlockStart(line) && startsTopLevelBlock(line);
+}
+
+inline bool MarkdownBlockScanner::isBlockStart(const QStringRef &line) const
+{
+    if (!previousLineBlank || isInsideCodeOrHtml()) {
+        return false;
+    }
+
+    const QStringRef trimmedLine = line.trimmed();
+    if (trimmedLine.isEmpty() || isIndented(line)) {
+        return false;
+    }
+
+    // block quotes separated by blank lines are merged into one
+    return !(insideBlockQuote && trimmedLine.startsWith(QLatin1Char('>')));
+}
+
+inline bool MarkdownBlockScanner::isInsideCodeOrHtml() const
+{
+    return insideCodeFence || insideHtmlComment || htmlDepth > 0;
+}
+
+inline void MarkdownBlockScanner::addLine(const QStringRef &line)
+{
+    const QStringRef trimmedLine = line.trimmed();
+    if (trimmedLine.isEmpty()) {
+        previousLineBlank = true;
+        return;
+    }
+
+    if (isCodeFence(line)) {
+        insideCodeFence = !insideCodeFence;
+    } else if (!insideCodeFence) {
+        const int commentStart = trimmedLine.lastIndexOf(QLatin1String("<!--"));
+        const int commentEnd = trimmedLine.lastIndexOf(QLatin1String("-->"));
+        if (commentStart >= 0 || commentEnd >= 0) {
+            insideHtmlComment = commentStart > commentEnd;
+        }
+
+        if (htmlDepth > 0 || trimmedLine.startsWith(QLatin1Char('<'))) {
+            htmlDepth = qMax(0, htmlDepth + htmlDepthChange(trimmedLine));
+        }
+    }
+
+    // lines without '>' lazily continue a block quote, unless a blank line is in between
+    if (trimmedLine.startsWith(QLatin1Char('>'))) {
+        insideBlockQuote = true;
+    } else if (previousLineBlank) {
+        insideBlockQuote = false;
+    }
+
+    previousLineBlank = false;
+}
+
+inline bool MarkdownBlockScanner::isIndented(const QStringRef &line)
+{
+    return line.startsWith(QLatin1Char(' ')) || line.startsWith(QLatin1Char('\t'));
+}
+
+inline bool MarkdownBlockScanner::isCodeFence(const QStringRef &line)
+{
+    return line.startsWith(QLatin1String("```")) || line.startsWith(QLatin1String("~~~"));
+}
+
+// bullet, numbered and alphabetic list items
+inline bool MarkdownBlockScanner::isListItem(const QStringRef &line)
+{
+    if (line.isEmpty()) {
+        return false;
+    }
+
+    int markerEnd = 0;
+    const QChar first = line.at(0);
+    if (first == QLatin1Char('*') || first == QLatin1Char('+') || first == QLatin1Char('-')) {
+        markerEnd = 1;
+    } else {
+        while (markerEnd < line.size() && line.at(markerEnd).isDigit()) {
+            markerEnd++;
+        }
+        if (markerEnd == 0 && first.isLetter()) {
+            markerEnd = 1;
+        }
+        if (markerEnd == 0 || markerEnd == line.size() ||
+            (line.at(markerEnd) != QLatin1Char('.') && line.at(markerEnd) != QLatin1Char(')'))) {
+            return false;
+        }
+        markerEnd++;
+    }
+
+    return markerEnd == line.size() || line.at(markerEnd).isSpace();
+}
+
+// a paragraph or header, but not a list, blockquote, table or HTML block
+inline bool MarkdownBlockScanner::startsTopLevelBlock(const QStringRef &line)
+{
+    const QChar first = line.at(0);
+    if (first == QLatin1Char('#')) {
+        return true;
+    }
+
+    return first.isLetter() && !isListItem(line) && !line.contains(QLatin1Char('|'));
+}
+
+// a guess of the nesting of HTML blocks, it's enough to err on the open side
+inline int MarkdownBlockScanner::htmlDepthChange(const QStringRef &line)
+{
+    static const char *const voidElements[] = {
+        "area", "base", "br", "col", "embed", "hr", "img", "input",
+        "link", "meta", "param", "source", "track", "wbr", 0
+    };
+
+    int change = 0;
+    for (int i = 0; i + 1 < line.size(); ++i) {
+        const QChar c = line.at(i);
+        const QChar next = line.at(i + 1);
+        if (c == QLatin1Char('/') && next == QLatin1Char('>')) {
+            change--;
+        } else if (c == QLatin1Char('<') && next == QLatin1Char('/')) {
+            change--;
+        } else if (c == QLatin1Char('<') && next.isLetter()) {
+            QString name;
+            int nameEnd = i + 1;
+            while (nameEnd < line.size() && line.at(nameEnd).isLetterOrNumber()) {
+                name += line.at(nameEnd).toLower();
+                nameEnd++;
+            }
+
+            // autolinks like <http://...> are no tags
+            if (nameEnd < line.size() && !line.at(nameEnd).isSpace() &&
+                line.at(nameEnd) != QLatin1Char('>') && line.at(nameEnd) != QLatin1Char('/')) {
+                continue;
+            }
+
+            // void elements like <br> are never closed, unless written as <br/>
+            bool voidElement = false;
+            for (int j = 0; voidElements[j]; ++j) {
+                voidElement = voidElement || name == QLatin1String(voidElements[j]);
+            }
+
+            int tagEnd = nameEnd;
+            while (tagEnd < line.size() && line.at(tagEnd) != QLatin1Char('>')) {
+                tagEnd++;
+            }
+
+            if (!voidElement || (tagEnd < line.size() && line.at(tagEnd - 1) == QLatin1Char('/'))) {
+                change++;
+            }
+        }
+    }
+    return change;
+}
+
+#endif // MARKDOWNBLOCKSCANNER_H
@@ -12,10 +12,12 @@ CONFIG += staticlib
 CONFIG += c++11
 
 SOURCES += \
+    pmhchunkedparser.cpp \
     pmhmarkdownparser.cpp \
     styleparser.cpp
 
 HEADERS  += \
+    pmhchunkedparser.h \
     pmhmarkdownparser.h \
     styleparser.h \
     definitions.h
@@ -29,3 +31,9 @@ HEADERS  += \
 #
 
 INCLUDEPATH += $$PWD/../../3rdparty/peg-markdown-highlight
+
+#
+# Markdown chunking helpers (header only)
+#
+
+INCLUDEPATH += $$PWD/../markdownchunks
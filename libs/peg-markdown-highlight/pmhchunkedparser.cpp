@@ -0,0 +1,200 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "pmhchunkedparser.h"
+
+#include <QString>
+#include <QThread>
+
+#include <stdlib.h>
+
+#include "chunkrunner.h"
+#include "markdownblockscanner.h"
+
+// smaller documents are parsed in one piece
+static const int MINIMUM_CHUNK_SIZE = 64 * 1024;
+
+
+namespace {
+
+// positions of the parser count code points, not UTF-16 code units
+int codePointCount(const QString &text, int position, int length)
+{
+    int count = length;
+    for (int i = position; i < position + length; ++i) {
+        if (text.at(i).isLowSurrogate()) {
+            count--;
+        }
+    }
+    return count;
+}
+
+// a cheap test for lines like "[id]: http://...", footnotes and other
+// false positives only cost a parse of the chunk's reference definitions
+bool mayContainReferenceDefinitions(const QString &text, int position, int length)
+{
+    const int end = position + length;
+    int lineStart = position;
+
+    while (lineStart < end) {
+        int lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd < 0 || lineEnd > end) {
+            lineEnd = end;
+        }
+
+        int i = lineStart;
+        while (i < lineEnd && i - lineStart < 3 && text.at(i) == QLatin1Char(' ')) {
+            ++i;
+        }
+
+        if (i < lineEnd && text.at(i) == QLatin1Char('[')) {
+            const int close = text.indexOf(QLatin1String("]:"), i);
+            if (close >= 0 && close < lineEnd) {
+                return true;
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    return false;
+}
+
+}
+
+
+QVector<PmhChunkedParser::Chunk> PmhChunkedParser::splitIntoChunks(const QString &text, int chunkSize)
+{
+    QVector<Chunk> chunks;
+
+    int chunkStart = 0;
+    int position = 0;
+    MarkdownBlockScanner scanner;
+
+    while (position < text.length()) {
+        int lineEnd = text.indexOf(QLatin1Char('\n'), position);
+        if (lineEnd < 0) {
+            lineEnd = text.length();
+        }
+
+        const QStringRef line = text.midRef(position, lineEnd - position);
+
+        // only split where nothing above can continue into the next block
+        if (position - chunkStart >= chunkSize && scanner.isChunkBoundary(line)) {
+            chunks.append(Chunk { chunkStart, position - chunkStart });
+            chunkStart = position;
+        }
+        scanner.addLine(line);
+
+        position = lineEnd + 1;
+    }
+
+    if (chunkStart < text.length() || chunks.isEmpty()) {
+        chunks.append(Chunk { chunkStart, text.length() - chunkStart });
+    }
+
+    return chunks;
+}
+
+pmh_element **PmhChunkedParser::parse(const QString &text, int extensions,
+                                      pmh_cancel_callback isCancelled, void *context,
+                                      int chunkSize)
+{
+    if (chunkSize <= 0) {
+        chunkSize = defaultChunkSize(text.length());
+    }
+
+    const QVector<Chunk> chunks = splitIntoChunks(text, chunkSize);
+    if (chunks.size() == 1) {
+        pmh_element **elements;
+        pmh_markdown_to_elements_cancellable(text.toUtf8().data(), extensions, &elements,
+                                             isCancelled, context);
+        return elements;
+    }
+
+    QVector<int> offsets(chunks.size());
+    QVector<int> lengths(chunks.size());
+    int offset = 0;
+    for (int i = 0; i < chunks.size(); ++i) {
+        offsets[i] = offset;
+        lengths[i] = codePointCount(text, chunks[i].position, chunks[i].length);
+        offset += lengths[i];
+    }
+
+    // reference links may refer to definitions in any other chunk, so
+    // the definitions of all chunks are collected first (in parallel and
+    // only from the chunks which may contain any)
+    QVector<pmh_element**> definitions(chunks.size(), 0);
+    pmh_element ***chunkDefinitions = definitions.data();
+    ChunkRunner::run(chunks.size(), [&](int i) {
+        if (!mayContainReferenceDefinitions(text, chunks[i].position, chunks[i].length)) {
+            chunkDefinitions[i] = (pmh_element **)calloc(pmh_NUM_TYPES, sizeof(pmh_element *));
+            return;
+        }
+
+        const QByteArray chunkText = text.mid(chunks[i].position, chunks[i].length).toUtf8();
+        chunkDefinitions[i] = pmh_markdown_to_references(chunkText.data(), extensions, isCancelled, context);
+    });
+
+    // the list keeps the order of a parse of the whole document
+    pmh_element **references = mergeResults(definitions, offsets, lengths);
+    if (!references) {
+        return 0;
+    }
+
+    QVector<pmh_element**> results(chunks.size(), 0);
+    pmh_element ***chunkResults = results.data();
+    ChunkRunner::run(chunks.size(), [&](int i) {
+        const QByteArray chunkText = text.mid(chunks[i].position, chunks[i].length).toUtf8();
+        pmh_markdown_to_elements_with_references(chunkText.data(), extensions, references,
+                                                 &chunkResults[i], isCancelled, context);
+    });
+
+    pmh_free_elements(references);
+
+    return mergeResults(results, offsets, lengths);
+}
+
+pmh_element **PmhChunkedParser::mergeResults(const QVector<pmh_element**> &results,
+                                             const QVector<int> &offsets, const QVector<int> &lengths)
+{
+    // a cancelled chunk leaves no result
+    bool cancelled = false;
+    for (int i = 0; i < results.size(); ++i) {
+        cancelled = cancelled || results[i] == 0;
+    }
+
+    pmh_element **elements = (pmh_element **)calloc(pmh_NUM_TYPES, sizeof(pmh_element *));
+    for (int i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            pmh_merge_elements(elements, results[i], offsets[i], lengths[i]);
+        }
+    }
+
+    if (cancelled) {
+        pmh_free_elements(elements);
+        return 0;
+    }
+
+    return elements;
+}
+
+int PmhChunkedParser::defaultChunkSize(int textLength)
+{
+    // a few chunks per thread even out differences in parse time
+    const int threads = qMax(1, QThread::idealThreadCount());
+    return qMax(MINIMUM_CHUNK_SIZE, textLength / (4 * threads));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PMHCHUNKEDPARSER_H
+#define PMHCHUNKEDPARSER_H
+
+#include <QVector>
+
+#include <pmh_definitions.h>
+#include <pmh_parser.h>
+
+class QString;
+
+
+// Parses large documents for highlighting in parts on a thread pool.
+// The document is only split at blank lines in front of a top-level
+// paragraph or header, so each part parses like it does in the whole
+// document. Reference links are resolved with the reference
+// definitions of the whole document, which are collected from the
+// parts in parallel as well.
+class PmhChunkedParser
+{
+public:
+    struct Chunk
+    {
+        int position;
+        int length;
+    };
+
+    static QVector<Chunk> splitIntoChunks(const QString &text, int chunkSize);
+
+    // Returns NULL if the parse was cancelled. With a chunk size of 0 it
+    // is chosen from the document size and the number of processors.
+    static pmh_element **parse(const QString &text, int extensions,
+                               pmh_cancel_callback isCancelled = 0, void *context = 0,
+                               int chunkSize = 0);
+
+private:
+    static pmh_element **mergeResults(const QVector<pmh_element**> &results,
+                                      const QVector<int> &offsets, const QVector<int> &lengths);
+    static int defaultChunkSize(int textLength);
+};
+
+#endif // PMHCHUNKEDPARSER_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "allocationcounter.h"
+
+#include <QtCore/qatomic.h>
+
+#include <new>
+#include <stdlib.h>
+
+// constant initialized, so allocations before main() are counted as well
+static QAtomicInteger<quint64> allocations(0);
+static QAtomicInteger<quint64> bytes(0);
+
+static inline void countAllocation(size_t size)
+{
+    allocations.fetchAndAddRelaxed(1);
+    bytes.fetchAndAddRelaxed(size);
+}
+
+AllocationCounter::Snapshot AllocationCounter::snapshot()
+{
+    Snapshot snapshot = { allocations.load(), bytes.load() };
+    return snapshot;
+}
+
+#ifdef __GLIBC__
+
+// operator new of libstdc++ calls malloc(), so replacing the
+// malloc family covers the C++ and the C code (discount, pmh)
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) __THROW
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) __THROW
+{
+    countAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+
+}
+
+#else
+
+// elsewhere only the C++ allocations are counted
+void *operator new(size_t size)
+{
+    countAllocation(size);
+    if (void *pointer = malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    countAllocation(size);
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) Q_DECL_NOTHROW
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) Q_DECL_NOTHROW
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) Q_DECL_NOTHROW
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    free(pointer);
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+
+// Counts the heap allocations of all threads of the benchmark. The
+// global allocation functions are replaced in allocationcounter.cpp,
+// which is only linked into the benchmarks. With glibc malloc() itself
+// is replaced, so the allocations of the C libraries are counted too.
+class AllocationCounter
+{
+public:
+    struct Snapshot
+    {
+        quint64 allocations;
+        quint64 bytes;
+    };
+
+    static Snapshot snapshot();
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,169 @@
+#
+# Benchmarks for CuteMarkEd
+#
+# Github : https://github.com/cloose/CuteMarkEd
+#
+# Usage: benchmark [--max-size <KB>] [--filter <regexp>]
+#                  [--output <file>] [--baseline <file> [--tolerance <percent>]]
+#                  [--budgets <file>] [--write-budgets <file>]
+#
+
+QT       += gui webkitwidgets
+
+TARGET = benchmark
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++11
+
+unix:!macx {
+  CONFIG += link_pkgconfig
+}
+
+APP_PATH = $$PWD/../../app
+
+INCLUDEPATH += $$APP_PATH
+
+SOURCES += \
+    allocationcounter.cpp \
+    benchmarkrunner.cpp \
+    corpusgenerator.cpp \
+    main.cpp \
+    $$APP_PATH/markdownhighlighter.cpp \
+    $$APP_PATH/highlightworkerthread.cpp \
+    $$APP_PATH/documentscheduler.cpp \
+    $$APP_PATH/hunspell/spellchecker.cpp
+
+win32 {
+    SOURCES += \
+        $$APP_PATH/hunspell/spellchecker_win.cpp
+}
+
+macx {
+    SOURCES += \
+        $$APP_PATH/hunspell/spellchecker_macx.cpp
+}
+
+unix {
+    SOURCES += \
+        $$APP_PATH/hunspell/spellchecker_unix.cpp
+}
+
+HEADERS += \
+    allocationcounter.h \
+    benchmarkrunner.h \
+    corpusgenerator.h \
+    $$APP_PATH/markdownhighlighter.h \
+    $$APP_PATH/highlightworkerthread.h
+
+RESOURCES += \
+    benchmark.qrc
+
+target.CONFIG += no_default_install
+
+#
+# JSON configuration library
+#
+INCLUDEPATH += $$PWD/../../libs/jsonconfig
+
+#
+# Add search paths below /usr/local for Mac OSX
+#
+macx {
+  LIBS += -L/usr/local/lib
+  INCLUDEPATH += /usr/local/include
+}
+
+##################################################
+# Use internal static library: app-static
+##################################################
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../app-static/release/ -lapp-static
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../app-static/debug/ -lapp-static
+else:unix: LIBS += -L$$OUT_PWD/../../app-static/ -lapp-static
+
+INCLUDEPATH += $$PWD/../../app-static
+DEPENDPATH += $$PWD/../../app-static
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../app-static/release/libapp-static.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../app-static/debug/libapp-static.a
+else:win32-msvc*:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../app-static/release/app-static.lib
+else:win32-msvc*:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../app-static/debug/app-static.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../../app-static/libapp-static.a
+
+#
+# PEG Markdown Highlight adapter library
+#
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../libs/peg-markdown-highlight/release/ -lpmh-adapter
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../libs/peg-markdown-highlight/debug/ -lpmh-adapter
+else:unix: LIBS += -L$$OUT_PWD/../../libs/peg-markdown-highlight/ -lpmh-adapter
+
+INCLUDEPATH += $$PWD/../../libs/ $$PWD/../../libs/peg-markdown-highlight
+DEPENDPATH += $$PWD/../../libs/peg-markdown-highlight
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libs/peg-markdown-highlight/release/libpmh-adapter.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libs/peg-markdown-highlight/debug/libpmh-adapter.a
+else:win32-msvc*:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libs/peg-markdown-highlight/release/pmh-adapter.lib
+else:win32-msvc*:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../libs/peg-markdown-highlight/debug/pmh-adapter.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../../libs/peg-markdown-highlight/libpmh-adapter.a
+
+#
+# peg-markdown-highlight
+#
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/peg-markdown-highlight/release/ -lpmh
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/peg-markdown-highlight/debug/ -lpmh
+else:unix: LIBS += -L$$OUT_PWD/../../3rdparty/peg-markdown-highlight/ -lpmh
+
+INCLUDEPATH += $$PWD/../../3rdparty/peg-markdown-highlight
+DEPENDPATH += $$PWD/../../3rdparty/peg-markdown-highlight
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/peg-markdown-highlight/release/libpmh.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/peg-markdown-highlight/debug/libpmh.a
+else:win32-msvc*:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/peg-markdown-highlight/release/pmh.lib
+else:win32-msvc*:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/peg-markdown-highlight/debug/pmh.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/peg-markdown-highlight/libpmh.a
+
+#
+# Discount library
+#
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/discount/release/ -ldiscount
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/discount/debug/ -ldiscount
+else:unix: LIBS += -L$$OUT_PWD/../../3rdparty/discount/ -lmarkdown
+
+INCLUDEPATH += $$PWD/../../3rdparty/
+DEPENDPATH += $$PWD/../../3rdparty/
+
+#win32:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/discount/release/libdiscount.a
+#else:win32:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/discount/debug/libdiscount.a
+
+#
+# hoedown
+#
+with_hoedown {
+    DEFINES += ENABLE_HOEDOWN
+
+    win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/hoedown/release/ -lhoedown
+    else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/hoedown/debug/ -lhoedown
+    else:unix: LIBS += -L$$OUT_PWD/../../3rdparty/hoedown/ -lhoedown
+
+    INCLUDEPATH += $$PWD/../../3rdparty/hoedown
+    DEPENDPATH += $$PWD/../../3rdparty/hoedown
+
+    #win32:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/hoedown/release/libhoedown.a
+    #else:win32:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../../3rdparty/hoedown/debug/libhoedown.a
+}
+
+#
+# hunspell
+#
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/hunspell/lib/ -lhunspell
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../3rdparty/hunspell/lib/ -lhunspell
+
+unix:!macx {
+  PKGCONFIG += hunspell
+}
+
+macx {
+  LIBS += -lhunspell
+}
+
+win32:INCLUDEPATH += $$PWD/../../3rdparty/hunspell/src
+win32:DEPENDPATH += $$PWD/../../3rdparty/hunspell/src
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "benchmarkrunner.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#include "allocationcounter.h"
+
+// repeat a benchmark until it ran at least this long (in ms)...
+static const qint64 MINIMUM_DURATION = 1000;
+static const int MINIMUM_ITERATIONS = 3;
+
+// ...but don't spend more time than this on a single large corpus
+static const qint64 MAXIMUM_DURATION = 10000;
+
+// differences below this (in ms) are measurement noise
+static const double NOISE_LEVEL = 0.05;
+
+
+BenchmarkRunner::BenchmarkRunner()
+{
+}
+
+void BenchmarkRunner::run(const QString &benchmark, const QString &corpus, qint64 bytes, const std::function<void ()> &function)
+{
+    run(benchmark, corpus, bytes, [](){}, function);
+}
+
+void BenchmarkRunner::run(const QString &benchmark, const QString &corpus, qint64 bytes,
+                          const std::function<void ()> &prepare, const std::function<void ()> &function)
+{
+    QVector<double> durations;
+    qint64 total = 0;
+    AllocationCounter::Snapshot before, after;
+
+    QElapsedTimer timer;
+    while (total < MAXIMUM_DURATION
+           && (durations.count() < MINIMUM_ITERATIONS || total < MINIMUM_DURATION)) {
+        prepare();
+
+        // the allocations of the last call are reported, the
+        // first call might still fill caches or initialize statics
+        before = AllocationCounter::snapshot();
+        timer.start();
+        function();
+        const qint64 nsecs = timer.nsecsElapsed();
+        after = AllocationCounter::snapshot();
+
+        durations.append(nsecs / 1000000.0);
+        total += nsecs / 1000000;
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    Result result;
+    result.benchmark = benchmark;
+    result.corpus = corpus;
+    result.bytes = bytes;
+    result.iterations = durations.count();
+    result.median = durations.at(durations.count() / 2);
+    result.minimum = durations.first();
+    result.allocations = after.allocations - before.allocations;
+    result.allocatedBytes = after.bytes - before.bytes;
+    benchmarkResults.append(result);
+
+    QTextStream err(stderr);
+    err << QString("%1 %2: %3 ms (%4 iterations) %5 allocations, %6 KB")
+           .arg(benchmark, -28).arg(corpus, -6).arg(result.median, 10, 'f', 3).arg(result.iterations)
+           .arg(result.allocations, 10).arg(result.allocatedBytes / 1024, 10)
+        << endl;
+}
+
+QList<BenchmarkRunner::Result> BenchmarkRunner::results() const
+{
+    return benchmarkResults;
+}
+
+QByteArray BenchmarkRunner::toJson() const
+{
+    QJsonArray results;
+    foreach (const Result &result, benchmarkResults) {
+        QJsonObject object;
+        object["benchmark"] = result.benchmark;
+        object["corpus"] = result.corpus;
+        object["bytes"] = result.bytes;
+        object["iterations"] = result.iterations;
+        object["median"] = result.median;
+        object["minimum"] = result.minimum;
+        object["allocations"] = result.allocations;
+        object["allocatedBytes"] = result.allocatedBytes;
+        results.append(object);
+    }
+
+    QJsonObject root;
+    root["unit"] = QStringLiteral("ms");
+    root["results"] = results;
+
+    return QJsonDocument(root).toJson();
+}
+
+int BenchmarkRunner::compareWithBaseline(const QByteArray &baseline, double tolerance) const
+{
+    QJsonArray baselineResults = QJsonDocument::fromJson(baseline).object().value("results").toArray();
+
+    QTextStream err(stderr);
+    int regressions = 0;
+
+    foreach (const Result &result, benchmarkResults) {
+        foreach (const QJsonValue &value, baselineResults) {
+            QJsonObject object = value.toObject();
+            if (object.value("benchmark").toString() != result.benchmark ||
+                object.value("corpus").toString() != result.corpus) {
+                continue;
+            }
+
+            const double expected = object.value("median").toDouble();
+            if (result.median > expected * (1.0 + tolerance) && result.median - expected > NOISE_LEVEL) {
+                err << QString("REGRESSION %1 %2: %3 ms (baseline %4 ms, +%5%)")
+                       .arg(result.benchmark).arg(result.corpus)
+                       .arg(result.median, 0, 'f', 3).arg(expected, 0, 'f', 3)
+                       .arg(expected > 0 ? (result.median / expected - 1.0) * 100.0 : 100.0, 0, 'f', 1)
+                    << endl;
+                ++regressions;
+            }
+            break;
+        }
+    }
+
+    return regressions;
+}
+
+int BenchmarkRunner::compareWithBudgets(const QByteArray &budgets) const
+{
+    QJsonArray budgetEntries = QJsonDocument::fromJson(budgets).object().value("budgets").toArray();
+
+    QTextStream err(stderr);
+    int exceeded = 0;
+
+    foreach (const Result &result, benchmarkResults) {
+        foreach (const QJsonValue &value, budgetEntries) {
+            QJsonObject object = value.toObject();
+            if (object.value("benchmark").toString() != result.benchmark ||
+                object.value("corpus").toString() != result.corpus) {
+                continue;
+            }
+
+            const qint64 allocations = object.value("allocations").toDouble();
+            const qint64 allocatedBytes = object.value("allocatedBytes").toDouble();
+            if (result.allocations > allocations || result.allocatedBytes > allocatedBytes) {
+                err << QString("OVER BUDGET %1 %2: %3 allocations, %4 bytes (budget %5 allocations, %6 bytes)")
+                       .arg(result.benchmark).arg(result.corpus)
+                       .arg(result.allocations).arg(result.allocatedBytes)
+                       .arg(allocations).arg(allocatedBytes)
+                    << endl;
+                ++exceeded;
+            }
+            break;
+        }
+    }
+
+    return exceeded;
+}
+
+QByteArray BenchmarkRunner::budgetsToJson(double headroom) const
+{
+    QJsonArray budgets;
+    foreach (const Result &result, benchmarkResults) {
+        QJsonObject object;
+        object["benchmark"] = result.benchmark;
+        object["corpus"] = result.corpus;
+        object["allocations"] = qint64(std::ceil(result.allocations * (1.0 + headroom)));
+        object["allocatedBytes"] = qint64(std::ceil(result.allocatedBytes * (1.0 + headroom)));
+        budgets.append(object);
+    }
+
+    QJsonObject root;
+    root["budgets"] = budgets;
+
+    return QJsonDocument(root).toJson();
+}
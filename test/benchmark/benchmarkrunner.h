@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+
+// Measures the run time and the heap allocations of benchmarks on
+// corpora of different size and compares the results with those of an
+// earlier (baseline) run and with the allocation budgets.
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        QString benchmark;
+        QString corpus;
+        qint64 bytes;
+        int iterations;
+        double median;      // milliseconds
+        double minimum;     // milliseconds
+        qint64 allocations; // per call
+        qint64 allocatedBytes;
+    };
+
+    BenchmarkRunner();
+
+    void run(const QString &benchmark, const QString &corpus, qint64 bytes, const std::function<void ()> &function);
+
+    // prepare is called before each call of function, but not measured
+    void run(const QString &benchmark, const QString &corpus, qint64 bytes,
+             const std::function<void ()> &prepare, const std::function<void ()> &function);
+
+    QList<Result> results() const;
+    QByteArray toJson() const;
+
+    // returns the number of results slower than in the baseline
+    int compareWithBaseline(const QByteArray &baseline, double tolerance) const;
+
+    // returns the number of results exceeding their allocation budget
+    int compareWithBudgets(const QByteArray &budgets) const;
+    QByteArray budgetsToJson(double headroom) const;
+
+private:
+    QList<Result> benchmarkResults;
+};
+
+#endif // BENCHMARKRUNNER_H
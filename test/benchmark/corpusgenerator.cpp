@@ -0,0 +1,262 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "corpusgenerator.h"
+
+static const QStringList WORDS = QStringList()
+    << "the" << "editor" << "preview" << "document" << "markdown" << "render"
+    << "quickly" << "table" << "of" << "contents" << "and" << "with"
+    << "syntax" << "highlighting" << "a" << "to" << "is" << "for"
+    << "reference" << "footnote" << "formula" << "diagram" << "theme" << "in"
+    << "window" << "keyboard" << "shortcut" << "paragraph" << "list" << "code";
+
+static const QStringList CJK = QStringList()
+    << QString::fromUtf8("\xe6\x96\x87\xe6\xa1\xa3")                     // 文档
+    << QString::fromUtf8("\xe7\xbc\x96\xe8\xbe\x91\xe5\x99\xa8")         // 编辑器
+    << QString::fromUtf8("\xe9\xa2\x84\xe8\xa7\x88")                     // 预览
+    << QString::fromUtf8("\xe3\x83\x9e\xe3\x83\xbc\xe3\x82\xaf\xe3\x83\x80\xe3\x82\xa6\xe3\x83\xb3") // マークダウン
+    << QString::fromUtf8("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e")         // 日本語
+    << QString::fromUtf8("\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4");        // 한국어
+
+static const QStringList EMOJI = QStringList()
+    << QString::fromUtf8("\xf0\x9f\x98\x80")   // grinning face
+    << QString::fromUtf8("\xf0\x9f\x9a\x80")   // rocket
+    << QString::fromUtf8("\xe2\x9c\x85")       // check mark
+    << QString::fromUtf8("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd"); // thumbs up with skin tone
+
+static const QStringList LANGUAGES = QStringList()
+    << "cpp" << "python" << "javascript" << "bash" << "";
+
+static const QStringList CODE_LINES = QStringList()
+    << "for (int i = 0; i < count; ++i) {"
+    << "    total += values[i] * factor;"
+    << "}"
+    << "if (!file.open(QIODevice::ReadOnly))"
+    << "    return false;"
+    << "def render(text): return converter.convert(text)"
+    << "const preview = document.getElementById('preview');"
+    << "echo \"$HOME\" | sed -e 's/a/b/g'";
+
+static const QStringList FORMULAS = QStringList()
+    << "x_k^2" << "\\alpha + \\beta" << "\\sqrt{a^2 + b^2}"
+    << "\\frac{n(n+1)}{2}" << "e^{i\\pi} + 1 = 0";
+
+
+CorpusGenerator::CorpusGenerator(unsigned int seed) :
+    engine(seed)
+{
+}
+
+QString CorpusGenerator::generate(int size)
+{
+    QString text = yamlHeader();
+
+    int number = 0;
+    while (text.size() < size) {
+        text += chapter(++number);
+    }
+
+    return text;
+}
+
+QString CorpusGenerator::yamlHeader()
+{
+    return QStringLiteral("---\n"
+                          "title: Benchmark Corpus\n"
+                          "author: CuteMarkEd\n"
+                          "tags: [markdown, benchmark]\n"
+                          "---\n\n");
+}
+
+QString CorpusGenerator::chapter(int number)
+{
+    QString text = QString("# Chapter %1\n\n").arg(number);
+
+    int references = 0;
+    const int sections = 4 + random(4);
+    for (int section = 0; section < sections; ++section) {
+        if (random(3) == 0) {
+            text += QString("## Section %1.%2\n\n").arg(number).arg(section + 1);
+        }
+
+        switch (random(10)) {
+        case 0:  text += table(); break;
+        case 1:  text += nestedList(3); break;
+        case 2:  text += fencedCode(); break;
+        case 3:  text += displayMath(); break;
+        case 4:  text += blockquote(); break;
+        case 5:  text += cjkParagraph(); break;
+        default: text += paragraph(number, &references); break;
+        }
+    }
+
+    // reference links and footnotes are defined at the end of the chapter
+    for (int i = 1; i <= references; ++i) {
+        text += QString("[ref-%1-%2]: https://example.com/%1/%2 \"Reference %2\"\n").arg(number).arg(i);
+    }
+    text += QLatin1Char('\n');
+    for (int i = 1; i <= references; ++i) {
+        text += QString("[^%1-%2]: %3.\n\n").arg(number).arg(i).arg(sentence(8));
+    }
+
+    return text;
+}
+
+QString CorpusGenerator::paragraph(int chapter, int *references)
+{
+    QString text;
+
+    const int sentences = 3 + random(4);
+    for (int i = 0; i < sentences; ++i) {
+        text += sentence(6 + random(12));
+
+        // inline syntax at the end of some sentences
+        switch (random(8)) {
+        case 0: text += QString(" *%1*").arg(pick(WORDS)); break;
+        case 1: text += QString(" **%1**").arg(pick(WORDS)); break;
+        case 2: text += QString(" `%1()`").arg(pick(WORDS)); break;
+        case 3:
+            ++*references;
+            text += QString(" [%1][ref-%2-%3]").arg(pick(WORDS)).arg(chapter).arg(*references);
+            text += QString("[^%1-%2]").arg(chapter).arg(*references);
+            break;
+        case 4: text += QString(" $%1$").arg(pick(FORMULAS)); break;
+        case 5: text += QLatin1Char(' ') + pick(EMOJI); break;
+        case 6: text += QString(" <https://example.com/%1>").arg(pick(WORDS)); break;
+        default: break;
+        }
+
+        text += QStringLiteral(". ");
+    }
+
+    return text + QStringLiteral("\n\n");
+}
+
+QString CorpusGenerator::cjkParagraph()
+{
+    QString text;
+
+    const int phrases = 10 + random(20);
+    for (int i = 0; i < phrases; ++i) {
+        text += pick(CJK);
+        if (random(5) == 0) {
+            text += QString::fromUtf8("\xe3\x80\x82");   // ideographic full stop
+        }
+    }
+
+    return text + pick(EMOJI) + QStringLiteral("\n\n");
+}
+
+QString CorpusGenerator::table()
+{
+    const int columns = 2 + random(4);
+    const int rows = 2 + random(10);
+
+    QString text = QStringLiteral("|");
+    QString separator = QStringLiteral("|");
+    for (int column = 0; column < columns; ++column) {
+        text += QString(" %1 |").arg(pick(WORDS));
+        separator += column == 0 ? QStringLiteral(":---|") : QStringLiteral("---:|");
+    }
+    text += QLatin1Char('\n') + separator + QLatin1Char('\n');
+
+    for (int row = 0; row < rows; ++row) {
+        text += QLatin1Char('|');
+        for (int column = 0; column < columns; ++column) {
+            text += QString(" %1 |").arg(column == 0 ? pick(WORDS) : QString::number(random(10000)));
+        }
+        text += QLatin1Char('\n');
+    }
+
+    return text + QLatin1Char('\n');
+}
+
+QString CorpusGenerator::nestedList(int depth)
+{
+    QString text;
+
+    const int items = 2 + random(4);
+    for (int i = 0; i < items; ++i) {
+        const QString indent(2 * (3 - depth), QLatin1Char(' '));
+        const bool ordered = depth % 2 == 0;
+        text += indent + (ordered ? QString("%1. ").arg(i + 1) : QStringLiteral("- "));
+        text += sentence(3 + random(8)) + QLatin1Char('\n');
+
+        if (depth > 1 && random(3) == 0) {
+            text += nestedList(depth - 1);
+        }
+    }
+
+    // only the outermost list is followed by an empty line
+    return depth == 3 ? text + QLatin1Char('\n') : text;
+}
+
+QString CorpusGenerator::fencedCode()
+{
+    QString text = QStringLiteral("```") + pick(LANGUAGES) + QLatin1Char('\n');
+
+    const int lines = 3 + random(15);
+    for (int i = 0; i < lines; ++i) {
+        text += pick(CODE_LINES) + QLatin1Char('\n');
+    }
+
+    return text + QStringLiteral("```\n\n");
+}
+
+QString CorpusGenerator::displayMath()
+{
+    // the evaluation order of arguments is unspecified, so
+    // only one random value is used per expression
+    const QString left = pick(FORMULAS);
+    const QString right = pick(FORMULAS);
+    return QString("$$\n%1 = %2\n$$\n\n").arg(left).arg(right);
+}
+
+QString CorpusGenerator::blockquote()
+{
+    QString text;
+
+    const int lines = 1 + random(4);
+    for (int i = 0; i < lines; ++i) {
+        text += QStringLiteral("> ") + sentence(5 + random(10)) + QLatin1Char('\n');
+    }
+
+    return text + QLatin1Char('\n');
+}
+
+QString CorpusGenerator::sentence(int words)
+{
+    QString text = pick(WORDS);
+    text[0] = text.at(0).toUpper();
+
+    for (int i = 1; i < words; ++i) {
+        text += QLatin1Char(' ') + pick(WORDS);
+    }
+
+    return text;
+}
+
+int CorpusGenerator::random(int count)
+{
+    // std::minstd_rand is fully specified by the standard, unlike
+    // the distributions of <random> or qrand()
+    return static_cast<int>(engine() % static_cast<unsigned int>(count));
+}
+
+const QString &CorpusGenerator::pick(const QStringList &list)
+{
+    return list.at(random(list.count()));
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+
+#include <random>
+
+
+// Generates Markdown documents of a given size with a realistic mix
+// of the syntax used in real documents. The same seed always produces
+// the same document on every platform.
+class CorpusGenerator
+{
+public:
+    explicit CorpusGenerator(unsigned int seed = 1);
+
+    QString generate(int size);
+
+private:
+    QString yamlHeader();
+    QString chapter(int number);
+    QString paragraph(int chapter, int *references);
+    QString cjkParagraph();
+    QString table();
+    QString nestedList(int depth);
+    QString fencedCode();
+    QString displayMath();
+    QString blockquote();
+    QString sentence(int words);
+
+    int random(int count);
+    const QString &pick(const QStringList &list);
+
+    std::minstd_rand engine;
+};
+
+#endif // CORPUSGENERATOR_H
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <climits>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFont>
+#include <QRegularExpression>
+#include <QTextDocument>
+#include <QTextStream>
+
+#include <converter/chunkedmarkdownconverter.h>
+#include <converter/discountmarkdownconverter.h>
+#include <converter/markdowndocument.h>
+#include <template/htmltemplate.h>
+#include <peg-markdown-highlight/styleparser.h>
+#include <pmhchunkedparser.h>
+#include <pmhmarkdownparser.h>
+#include <pmh_parser.h>
+#include <markdownhighlighter.h>
+#include <slidelinemapping.h>
+#include <wordcounter.h>
+#include <yamlheaderchecker.h>
+
+#ifdef ENABLE_HOEDOWN
+#include <converter/hoedownmarkdownconverter.h>
+#endif
+
+#include "benchmarkrunner.h"
+#include "corpusgenerator.h"
+
+// headroom of the budgets written with --write-budgets
+static const double BUDGET_HEADROOM = 0.1;
+
+static const QString HTML_TEMPLATE = QStringLiteral("<html><head><!--__HTML_HEADER__--></head><body><!--__HTML_CONTENT__--></body></html>");
+
+struct Corpus
+{
+    QString name;
+    int size;
+};
+
+static const Corpus CORPORA[] = {
+    { "10KB",  10 * 1024 },
+    { "100KB", 100 * 1024 },
+    { "1MB",   1024 * 1024 },
+    { "10MB",  10 * 1024 * 1024 },
+    { "50MB",  50 * 1024 * 1024 }
+};
+
+static void benchmarkConverter(BenchmarkRunner &runner, const QString &name, MarkdownConverter *converter,
+                               const Corpus &corpus, const QString &text, qint64 bytes)
+{
+    MarkdownConverter::ConverterOptions options(MarkdownConverter::TableOfContentsOption |
+                                                MarkdownConverter::NoStyleOption |
+                                                MarkdownConverter::ExtraFootnoteOption);
+
+    runner.run(name, corpus.name, bytes, [&]() {
+        MarkdownDocument *document = converter->createDocument(text, options);
+        converter->renderAsHtml(document);
+        delete document;
+    });
+}
+
+static QVector<PegMarkdownHighlight::HighlightingStyle> loadHighlightingStyles()
+{
+    QFile file(":/theme/default.txt");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QVector<PegMarkdownHighlight::HighlightingStyle>();
+    }
+
+    PegMarkdownHighlight::StyleParser parser(QString::fromUtf8(file.readAll()));
+    return parser.highlightingStyles(QFont("Monospace", 10));
+}
+
+int main(int argc, char *argv[])
+{
+    // the highlighter needs a GUI application, but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    app.setApplicationName("benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the CuteMarkEd components on generated Markdown corpora.");
+    parser.addHelpOption();
+    QCommandLineOption outputOption("output", "Write the results as JSON to <file> instead of stdout.", "file");
+    QCommandLineOption baselineOption("baseline", "Fail if a benchmark is slower than in the results of <file>.", "file");
+    QCommandLineOption toleranceOption("tolerance", "Allowed slowdown compared to the baseline in <percent> (default: 10).", "percent", "10");
+    QCommandLineOption maxSizeOption("max-size", "Skip corpora larger than <size> in KB (default: all corpora).", "size");
+    QCommandLineOption filterOption("filter", "Run only the benchmarks matching the regular <expression>.", "expression");
+    QCommandLineOption budgetsOption("budgets", "Fail if a benchmark allocates more than budgeted in <file>.", "file");
+    QCommandLineOption writeBudgetsOption("write-budgets", "Write the allocations plus 10% as budgets to <file>.", "file");
+    parser.addOption(outputOption);
+    parser.addOption(baselineOption);
+    parser.addOption(toleranceOption);
+    parser.addOption(maxSizeOption);
+    parser.addOption(filterOption);
+    parser.addOption(budgetsOption);
+    parser.addOption(writeBudgetsOption);
+    parser.process(app);
+
+    const int maximumSize = parser.isSet(maxSizeOption) ? parser.value(maxSizeOption).toInt() * 1024 : INT_MAX;
+    const QRegularExpression filter(parser.value(filterOption));
+
+    BenchmarkRunner runner;
+    DiscountMarkdownConverter discountConverter;
+    ChunkedMarkdownConverter chunkedConverter(new DiscountMarkdownConverter());
+#ifdef ENABLE_HOEDOWN
+    HoedownMarkdownConverter hoedownConverter;
+#endif
+    PmhMarkdownParser pmhParser;
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+    const QVector<PegMarkdownHighlight::HighlightingStyle> highlightingStyles = loadHighlightingStyles();
+
+    for (const Corpus &corpus : CORPORA) {
+        if (corpus.size > maximumSize) {
+            continue;
+        }
+
+        // every corpus is generated with the same seed, so
+        // the smaller corpora are prefixes of the larger ones
+        CorpusGenerator generator;
+        const QString text = generator.generate(corpus.size);
+        const qint64 bytes = text.toUtf8().size();
+
+        if (filter.match("DiscountMarkdownConverter").hasMatch()) {
+            benchmarkConverter(runner, "DiscountMarkdownConverter", &discountConverter, corpus, text, bytes);
+        }
+
+        if (filter.match("ChunkedMarkdownConverter").hasMatch()) {
+            benchmarkConverter(runner, "ChunkedMarkdownConverter", &chunkedConverter, corpus, text, bytes);
+        }
+
+#ifdef ENABLE_HOEDOWN
+        if (filter.match("HoedownMarkdownConverter").hasMatch()) {
+            benchmarkConverter(runner, "HoedownMarkdownConverter", &hoedownConverter, corpus, text, bytes);
+        }
+#endif
+
+        if (filter.match("PmhMarkdownParser").hasMatch()) {
+            runner.run("PmhMarkdownParser", corpus.name, bytes, [&]() {
+                pmhParser.parseMarkdown(text);
+            });
+        }
+
+        if (filter.match("PmhChunkedParser").hasMatch()) {
+            // the parse of the highlighter thread
+            runner.run("PmhChunkedParser", corpus.name, bytes, [&]() {
+                pmh_free_elements(PmhChunkedParser::parse(text, pmh_EXT_NONE));
+            });
+        }
+
+        if (filter.match("HtmlPreviewGenerator cycle").hasMatch()) {
+            // the work of the preview generator after every edit
+            runner.run("HtmlPreviewGenerator cycle", corpus.name, bytes, [&]() {
+                MarkdownDocument *document = discountConverter.createDocument(text, MarkdownConverter::ExtraFootnoteOption |
+                                                                                    MarkdownConverter::TableOfContentsOption);
+                const QString html = discountConverter.renderAsHtml(document);
+                htmlTemplate.render(html, Template::MathSupport | Template::CodeHighlighting | Template::DiagramSupport);
+                discountConverter.renderAsTableOfContents(document);
+                delete document;
+            });
+        }
+
+        if (filter.match("HtmlTemplate::render").hasMatch()) {
+            MarkdownDocument *document = discountConverter.createDocument(text, MarkdownConverter::ExtraFootnoteOption);
+            const QString html = discountConverter.renderAsHtml(document);
+            delete document;
+
+            runner.run("HtmlTemplate::render", corpus.name, bytes, [&]() {
+                htmlTemplate.render(html, Template::MathSupport | Template::CodeHighlighting | Template::DiagramSupport);
+            });
+        }
+
+        if (filter.match("MarkdownHighlighter::resultReady").hasMatch()) {
+            QTextDocument document(text);
+            MarkdownHighlighter highlighter(&document, 0);
+            highlighter.setStyles(highlightingStyles);
+
+            // the highlighter takes ownership of the elements,
+            // so every call needs the result of a new parse
+            const QByteArray utf8 = text.toUtf8();
+            pmh_element **elements = 0;
+
+            runner.run("MarkdownHighlighter::resultReady", corpus.name, bytes, [&]() {
+                QByteArray input = utf8;
+                pmh_markdown_to_elements(input.data(), pmh_EXT_NONE, &elements);
+            }, [&]() {
+                QMetaObject::invokeMethod(&highlighter, "resultReady", Qt::DirectConnection,
+                                          Q_ARG(pmh_element**, elements), Q_ARG(unsigned long, 0), Q_ARG(int, 0));
+            });
+        }
+
+        if (filter.match("YamlHeaderChecker").hasMatch()) {
+            runner.run("YamlHeaderChecker", corpus.name, bytes, [&]() {
+                YamlHeaderChecker checker(text);
+                checker.body();
+            });
+        }
+
+        if (filter.match("SlideLineMapping::build").hasMatch()) {
+            runner.run("SlideLineMapping::build", corpus.name, bytes, [&]() {
+                SlideLineMapping mapping;
+                mapping.build(text);
+            });
+        }
+
+        if (filter.match("WordCounter::countWords").hasMatch()) {
+            runner.run("WordCounter::countWords", corpus.name, bytes, [&]() {
+                WordCounter::countWords(text);
+            });
+        }
+
+        if (filter.match("WordCounter::distinctWords").hasMatch()) {
+            // the words offered by the completer of the editor
+            runner.run("WordCounter::distinctWords", corpus.name, bytes, [&]() {
+                WordCounter::distinctWords(text);
+            });
+        }
+    }
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Could not write %s", qPrintable(file.fileName()));
+            return 2;
+        }
+        file.write(runner.toJson());
+    } else {
+        QTextStream(stdout) << runner.toJson();
+    }
+
+    if (parser.isSet(writeBudgetsOption)) {
+        QFile file(parser.value(writeBudgetsOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Could not write %s", qPrintable(file.fileName()));
+            return 2;
+        }
+        file.write(runner.budgetsToJson(BUDGET_HEADROOM));
+    }
+
+    int result = 0;
+
+    if (parser.isSet(baselineOption)) {
+        QFile file(parser.value(baselineOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical("Could not read %s", qPrintable(file.fileName()));
+            return 2;
+        }
+
+        const double tolerance = parser.value(toleranceOption).toDouble() / 100.0;
+        if (runner.compareWithBaseline(file.readAll(), tolerance) > 0) {
+            result = 1;
+        }
+    }
+
+    if (parser.isSet(budgetsOption)) {
+        QFile file(parser.value(budgetsOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical("Could not read %s", qPrintable(file.fileName()));
+            return 2;
+        }
+
+        if (runner.compareWithBudgets(file.readAll()) > 0) {
+            result = 1;
+        }
+    }
+
+    return result;
+}
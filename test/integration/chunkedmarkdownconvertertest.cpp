@@ -0,0 +1,272 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "chunkedmarkdownconvertertest.h"
+
+#include <QtTest>
+
+#include <converter/chunkedmarkdownconverter.h>
+#include <converter/discountmarkdownconverter.h>
+#include <converter/markdowndocument.h>
+#ifdef ENABLE_HOEDOWN
+#include <converter/hoedownmarkdownconverter.h>
+#endif
+#include "loremipsumtestdata.h"
+
+static const int CHUNK_SIZE = 256;
+
+static QString mixedBlocksText()
+{
+    QString text;
+    for (int i = 0; i < 10; ++i) {
+        text += QString("# Header %1\n"
+                        "\n"
+                        "Paragraph with *emphasis*, **strong**, `code` and a [reference link][ref%1].\n"
+                        "\n"
+                        "- first item\n"
+                        "- second item\n"
+                        "\n"
+                        "    continued item\n"
+                        "\n"
+                        "a. alphabetic item\n"
+                        "\n"
+                        "b. alphabetic item\n"
+                        "\n"
+                        "    indented code\n"
+                        "\n"
+                        "```\n"
+                        "fenced code\n"
+                        "\n"
+                        "Not a paragraph\n"
+                        "```\n"
+                        "\n"
+                        "> a quote\n"
+                        "\n"
+                        "<div>\n"
+                        "<div>\n"
+                        "\n"
+                        "</div>\n"
+                        "\n"
+                        "HTML block\n"
+                        "</div>\n"
+                        "\n"
+                        "Header %1\n"
+                        "---------\n"
+                        "\n").arg(i);
+    }
+    for (int i = 0; i < 10; ++i) {
+        text += QString("[ref%1]: http://example.com/%1 \"Title\"\n").arg(i);
+    }
+    return text;
+}
+
+static QString footnotesText()
+{
+    QString text;
+    for (int i = 0; i < 10; ++i) {
+        text += QString("# Chapter %1\n"
+                        "\n"
+                        "Paragraph with a footnote[^%1a] and a [reference link][ref%1].\n"
+                        "\n"
+                        "Paragraph with another footnote[^%1b].\n"
+                        "\n"
+                        "[^%1a]: First footnote of chapter %1.\n"
+                        "[^%1b]: Second footnote of chapter %1.\n"
+                        "\n"
+                        "[ref%1]: http://example.com/%1\n"
+                        "\n").arg(i);
+    }
+    return text;
+}
+
+static MarkdownConverter *createConverter(const QString &name)
+{
+#ifdef ENABLE_HOEDOWN
+    if (name == "hoedown") {
+        return new HoedownMarkdownConverter();
+    }
+#endif
+    Q_UNUSED(name)
+    return new DiscountMarkdownConverter();
+}
+
+static QString renderHtml(MarkdownConverter *converter, const QString &text, MarkdownConverter::ConverterOptions options)
+{
+    MarkdownDocument *document = converter->createDocument(text, options);
+    QString html = converter->renderAsHtml(document);
+    delete document;
+    return html;
+}
+
+static QString renderTableOfContents(MarkdownConverter *converter, const QString &text, MarkdownConverter::ConverterOptions options)
+{
+    MarkdownDocument *document = converter->createDocument(text, options);
+    QString toc = converter->renderAsTableOfContents(document);
+    delete document;
+    return toc;
+}
+
+void ChunkedMarkdownConverterTest::splitsOnlyInFrontOfTopLevelParagraphs()
+{
+    const QString text = "Paragraph one\n"
+                         "\n"
+                         "- item\n"
+                         "\n"
+                         "a. item\n"
+                         "\n"
+                         "    code\n"
+                         "\n"
+                         "> quote\n"
+                         "\n"
+                         "# Header\n";
+
+    QVector<ChunkedMarkdownConverter::Chunk> chunks = ChunkedMarkdownConverter::splitIntoChunks(text, 1);
+
+    QCOMPARE(chunks.size(), 2);
+    QCOMPARE(chunks[1].position, text.indexOf("# Header"));
+    QCOMPARE(chunks[1].firstLine, 11);
+}
+
+void ChunkedMarkdownConverterTest::doesNotSplitInsideHtmlBlocks()
+{
+    const QString text = "<div>\n"
+                         "<div>\n"
+                         "\n"
+                         "</div>\n"
+                         "\n"
+                         "inside\n"
+                         "</div>\n"
+                         "\n"
+                         "outside\n";
+
+    QVector<ChunkedMarkdownConverter::Chunk> chunks = ChunkedMarkdownConverter::splitIntoChunks(text, 1);
+
+    QCOMPARE(chunks.size(), 2);
+    QCOMPARE(chunks[1].position, text.indexOf("outside"));
+}
+
+void ChunkedMarkdownConverterTest::rejectsConflictingReferenceDefinitions()
+{
+    QString definitions;
+    QVERIFY(ChunkedMarkdownConverter::collectReferenceDefinitions("[a]: http://a\n\ntext\n\n[b]: http://b\n", &definitions));
+    QCOMPARE(definitions, QStringLiteral("[a]: http://a\n[b]: http://b\n"));
+
+    definitions.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectReferenceDefinitions("[a]: http://a\n[A]: http://b\n", &definitions));
+
+    definitions.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectReferenceDefinitions("```\n[a]: http://a\n```\n", &definitions));
+}
+
+void ChunkedMarkdownConverterTest::collectsOnlySingleLineFootnotes()
+{
+    QString definitions;
+    QVERIFY(ChunkedMarkdownConverter::collectFootnoteDefinitions("[^1]: one\n[a]: http://a\n\ntext[^1]\n\n[^2]: two\n", &definitions));
+    QCOMPARE(definitions, QStringLiteral("[^1]: one\n\n[^2]: two\n\n"));
+
+    definitions.clear();
+    QVERIFY(ChunkedMarkdownConverter::collectReferenceDefinitions("[^1]: one\n[a]: http://a\n", &definitions, true));
+    QCOMPARE(definitions, QStringLiteral("[a]: http://a\n"));
+
+    definitions.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectFootnoteDefinitions("[^1]: one\n    continued\n", &definitions));
+
+    definitions.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectFootnoteDefinitions("[^1]: see[^2]\n\n[^2]: two\n", &definitions));
+
+    definitions.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectFootnoteDefinitions("[^1]: one\n\n[^1]: two\n", &definitions));
+}
+
+void ChunkedMarkdownConverterTest::collectsOnlyUnambiguousHeaders()
+{
+    QString headers;
+    QVERIFY(ChunkedMarkdownConverter::collectHeaders("# One\ntext\n\nTwo\n===\n\n```\n# code\n```\n\n    # code\n", &headers));
+    QCOMPARE(headers, QStringLiteral("# One\n\nTwo\n===\n\n"));
+
+    headers.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectHeaders("text\n# Header\n", &headers));
+
+    headers.clear();
+    QVERIFY(!ChunkedMarkdownConverter::collectHeaders("> # Header\n", &headers));
+}
+
+void ChunkedMarkdownConverterTest::rendersSameHtmlAsSerialConverter_data()
+{
+    QTest::addColumn<QString>("converter");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("options");
+
+    const int options = MarkdownConverter::TableOfContentsOption | MarkdownConverter::NoStyleOption;
+    const QString loremIpsum = (fiveHundredWordsLoremIpsumText + "\n") +
+                               (fiveHundredWordsLoremIpsumText + "\n") +
+                               (fiveHundredWordsLoremIpsumText + "\n");
+
+    QTest::newRow("lorem ipsum") << "discount" << loremIpsum << options;
+    QTest::newRow("mixed blocks") << "discount" << mixedBlocksText() << options;
+    QTest::newRow("source lines") << "discount" << mixedBlocksText() << (options | MarkdownConverter::SourceLineOption);
+    QTest::newRow("footnotes") << "discount" << (mixedBlocksText() + "\nText[^1]\n\n[^1]: A footnote\n")
+                               << (options | MarkdownConverter::ExtraFootnoteOption);
+    QTest::newRow("footnotes in several chunks") << "discount" << footnotesText()
+                                                 << (options | MarkdownConverter::ExtraFootnoteOption);
+    QTest::newRow("footnote referenced in two chunks") << "discount" << (footnotesText() + "\nAgain[^0a]\n")
+                                                       << (options | MarkdownConverter::ExtraFootnoteOption);
+#ifdef ENABLE_HOEDOWN
+    QTest::newRow("hoedown") << "hoedown" << mixedBlocksText() << options;
+    QTest::newRow("hoedown source lines") << "hoedown" << mixedBlocksText() << (options | MarkdownConverter::SourceLineOption);
+    QTest::newRow("hoedown footnotes in several chunks") << "hoedown" << footnotesText()
+                                                         << (options | MarkdownConverter::ExtraFootnoteOption);
+#endif
+}
+
+void ChunkedMarkdownConverterTest::rendersSameHtmlAsSerialConverter()
+{
+    QFETCH(QString, converter);
+    QFETCH(QString, text);
+    QFETCH(int, options);
+
+    QVERIFY(ChunkedMarkdownConverter::splitIntoChunks(text, CHUNK_SIZE).size() > 2);
+
+    QScopedPointer<MarkdownConverter> serialConverter(createConverter(converter));
+    QScopedPointer<MarkdownConverter> chunkedConverter(new ChunkedMarkdownConverter(createConverter(converter), CHUNK_SIZE));
+
+    MarkdownConverter::ConverterOptions converterOptions(options);
+    QCOMPARE(renderHtml(chunkedConverter.data(), text, converterOptions), renderHtml(serialConverter.data(), text, converterOptions));
+}
+
+void ChunkedMarkdownConverterTest::rendersSameTableOfContentsAsSerialConverter_data()
+{
+    QTest::addColumn<QString>("converter");
+
+    QTest::newRow("discount") << "discount";
+#ifdef ENABLE_HOEDOWN
+    QTest::newRow("hoedown") << "hoedown";
+#endif
+}
+
+void ChunkedMarkdownConverterTest::rendersSameTableOfContentsAsSerialConverter()
+{
+    QFETCH(QString, converter);
+
+    const QString text = mixedBlocksText();
+    const MarkdownConverter::ConverterOptions options(MarkdownConverter::TableOfContentsOption);
+
+    QScopedPointer<MarkdownConverter> serialConverter(createConverter(converter));
+    QScopedPointer<MarkdownConverter> chunkedConverter(new ChunkedMarkdownConverter(createConverter(converter), CHUNK_SIZE));
+
+    QCOMPARE(renderTableOfContents(chunkedConverter.data(), text, options),
+             renderTableOfContents(serialConverter.data(), text, options));
+}
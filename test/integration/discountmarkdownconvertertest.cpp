@@ -86,6 +86,48 @@ void DiscountMarkdownConverterTest::ignoresSuperscriptIfDisabled()
     QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("<p>a^2</p>"));
 }
 
+void DiscountMarkdownConverterTest::addsSourceLineAnchorsIfEnabled()
+{
+    MarkdownDocument *doc = converter->createDocument(QStringLiteral("first\n\nsecond"), DiscountMarkdownConverter::SourceLineOption);
+    QString html = converter->renderAsHtml(doc);
+
+    QVERIFY(html.contains(QStringLiteral("<div data-source-line=\"1\"></div>")));
+    QVERIFY(html.contains(QStringLiteral("<div data-source-line=\"3\"></div>")));
+    QVERIFY(html.indexOf(QStringLiteral("<div data-source-line=\"1\"></div>")) < html.indexOf(QStringLiteral("<p>first</p>")));
+    QVERIFY(html.indexOf(QStringLiteral("<p>first</p>")) < html.indexOf(QStringLiteral("<div data-source-line=\"3\"></div>")));
+    QVERIFY(html.indexOf(QStringLiteral("<div data-source-line=\"3\"></div>")) < html.indexOf(QStringLiteral("<p>second</p>")));
+}
+
+void DiscountMarkdownConverterTest::sourceLineAnchorsKeepHtmlStructure_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::newRow("block quotes") << "> first\n\n> same quote\n\nparagraph";
+    QTest::newRow("nested html blocks") << "<div>\n<div>\n\ninner\n</div>\n\nouter\n</div>\n\nparagraph";
+    QTest::newRow("lists") << "- item\n\n- item\n\n    continued\n\n1. item\n\n2. item\n\nparagraph";
+    QTest::newRow("alphabetic lists") << "a. item\n\nb. item\n\nparagraph";
+    QTest::newRow("code") << "    code\n\n    code\n\n```\nfenced\n\ncode\n```\n\nparagraph";
+}
+
+void DiscountMarkdownConverterTest::sourceLineAnchorsKeepHtmlStructure()
+{
+    QFETCH(QString, text);
+
+    MarkdownDocument *doc = converter->createDocument(text, DiscountMarkdownConverter::SourceLineOption);
+    QString annotatedHtml = converter->renderAsHtml(doc);
+    delete doc;
+
+    doc = converter->createDocument(text, 0);
+    QString html = converter->renderAsHtml(doc);
+    delete doc;
+
+    // without the anchors the HTML must be the same
+    annotatedHtml.remove(QRegularExpression("<div data-source-line=\"\\d+\"></div>"));
+    annotatedHtml.replace(QRegularExpression(">\\s+<"), "><");
+    html.replace(QRegularExpression(">\\s+<"), "><");
+
+    QCOMPARE(annotatedHtml.trimmed(), html.trimmed());
+}
+
 void DiscountMarkdownConverterTest::benchmark_data()
 {
     QTest::addColumn<QString>("text");
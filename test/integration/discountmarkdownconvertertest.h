@@ -36,6 +36,9 @@ private slots:
 
     void supportsSuperscriptIfEnabled();
     void ignoresSuperscriptIfDisabled();
+    void addsSourceLineAnchorsIfEnabled();
+    void sourceLineAnchorsKeepHtmlStructure_data();
+    void sourceLineAnchorsKeepHtmlStructure();
 
     void benchmark_data();
     void benchmark();
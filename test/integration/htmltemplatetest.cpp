@@ -18,6 +18,7 @@
 
 #include <QtTest>
 
+#include <fragmentcache.h>
 #include <template/htmltemplate.h>
 #include "loremipsumtestdata.h"
 
@@ -25,7 +26,7 @@ static const QString HTML_TEMPLATE = QStringLiteral("<html><head><!--__HTML_HEAD
 static const QString SCROLL_SCRIPT = QStringLiteral("<script type=\"text/javascript\">window.onscroll = function() { synchronizer.webViewScrolled(); }; </script>");
 static const QString MERMAID_CSS   = QStringLiteral("<link rel=\"stylesheet\" href=\"qrc:/scripts/mermaid/mermaid.css\">");
 static const QString MERMAID_JS    = QStringLiteral("<script src=\"qrc:/scripts/mermaid/mermaid.full.min.js\"></script>");
-static const QString HIGHLIGHT_JS  = QStringLiteral("<link rel=\"stylesheet\" href=\"qrc:/scripts/highlight.js/styles/.css\">\n<script src=\"qrc:/scripts/highlight.js/highlight.pack.js\"></script>\n<script>hljs.initHighlightingOnLoad();</script>");
+static const QString HIGHLIGHT_CSS = QStringLiteral("<link rel=\"stylesheet\" href=\"qrc:/scripts/highlight.js/styles/.css\">");
 
 void HtmlTemplateTest::rendersContentInsideBodyTags()
 {
@@ -44,9 +45,9 @@ void HtmlTemplateTest::rendersMermaidGraphInsideCodeTags()
 
     QString html = htmlTemplate.render("<pre><code class=\"mermaid\">TEST</code></pre>", HtmlTemplate::DiagramSupport);
 
-    const QString expected = QStringLiteral("<html><head>%1\n%2\n%3\n</head><body><pre><code class=\"mermaid\">TEST</code></pre></body></html>")
-        .arg(SCROLL_SCRIPT).arg(MERMAID_CSS).arg(MERMAID_JS);
-    QCOMPARE(html, expected);
+    QVERIFY(html.startsWith(QStringLiteral("<html><head>%1\n%2\n").arg(SCROLL_SCRIPT).arg(MERMAID_CSS)));
+    QVERIFY(html.contains(MERMAID_JS));
+    QVERIFY(html.endsWith("</head><body><pre><code class=\"mermaid\">TEST</code></pre></body></html>"));
 }
 
 void HtmlTemplateTest::replacesMermaidCodeTagsByDivTagsIfCodeHighlightingEnabled()
@@ -55,7 +56,119 @@ void HtmlTemplateTest::replacesMermaidCodeTagsByDivTagsIfCodeHighlightingEnabled
 
     QString html = htmlTemplate.render("<pre><code class=\"mermaid\">TEST</code></pre>", HtmlTemplate::DiagramSupport | HtmlTemplate::CodeHighlighting);
 
-    const QString expected = QStringLiteral("<html><head>%1\n%2\n%3\n%4\n</head><body><div class=\"mermaid\">\nTEST</div></body></html>")
-        .arg(SCROLL_SCRIPT).arg(HIGHLIGHT_JS).arg(MERMAID_CSS).arg(MERMAID_JS);
-    QCOMPARE(html, expected);
+    QVERIFY(html.startsWith(QStringLiteral("<html><head>%1\n%2\n%3\n").arg(SCROLL_SCRIPT).arg(HIGHLIGHT_CSS).arg(MERMAID_CSS)));
+    QVERIFY(html.contains(MERMAID_JS));
+    QVERIFY(html.endsWith("</head><body><div class=\"mermaid\">\nTEST</div></body></html>"));
+}
+
+void HtmlTemplateTest::replacesRenderedDiagramsByCachedFragments()
+{
+    FragmentCache::instance()->insert("mermaid", "A-->B", "<svg>diagram</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<pre><code class=\"mermaid\">A--&gt;B\n</code></pre>", HtmlTemplate::DiagramSupport);
+
+    QVERIFY(html.endsWith("</head><body><div class=\"mermaid\" data-processed=\"true\"><svg>diagram</svg></div></body></html>"));
+    QVERIFY(html.contains(MERMAID_CSS));
+    QVERIFY(!html.contains(MERMAID_JS));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::exportsCachedDiagrams()
+{
+    FragmentCache::instance()->insert("mermaid", "A-->B", "<svg>diagram</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.exportAsHtml(QString(), "<pre><code class=\"mermaid\">A--&gt;B</code></pre>", HtmlTemplate::DiagramSupport);
+
+    QVERIFY(html.contains("<div class=\"mermaid\" data-processed=\"true\"><svg>diagram</svg></div>"));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::replacesTypesetFormulasByCachedFragments()
+{
+    FragmentCache::instance()->insert("math-display", "x < 1", "<svg>display</svg>");
+    FragmentCache::instance()->insert("math-inline", "y", "<svg>inline</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<p>$$x &lt; 1$$ and \\(y\\)</p>", HtmlTemplate::MathSupport);
+
+    QVERIFY(html.contains("<p><svg>display</svg> and <svg>inline</svg></p>"));
+    QVERIFY(!html.contains("MathJax.js"));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::loadsMathJaxOnlyForFormulasNotTypesetYet()
+{
+    FragmentCache::instance()->insert("math-inline", "y", "<svg>inline</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<p>$y$ and $z$</p>", HtmlTemplate::MathSupport | HtmlTemplate::MathInlineSupport);
+
+    QVERIFY(html.contains("<p><svg>inline</svg> and $z$</p>"));
+    QVERIFY(html.contains("MathJax.js?config=TeX-AMS-MML_SVG"));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::ignoresFormulasInsideCodeTags()
+{
+    FragmentCache::instance()->insert("math-display", "x", "<svg>display</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<pre><code>$$x$$</code></pre>", HtmlTemplate::MathSupport);
+
+    QVERIFY(html.contains("<pre><code>$$x$$</code></pre>"));
+    QVERIFY(!html.contains("MathJax.js"));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::ignoresFormulasInsideDiagrams()
+{
+    FragmentCache::instance()->insert("math-inline", "x", "<svg>inline</svg>");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<pre><code class=\"mermaid\">A[$x$]--&gt;B</code></pre><p>$x$</p>",
+                                       HtmlTemplate::MathSupport | HtmlTemplate::MathInlineSupport |
+                                       HtmlTemplate::DiagramSupport | HtmlTemplate::CodeHighlighting);
+
+    QVERIFY(html.contains("<div class=\"mermaid\">\nA[$x$]--&gt;B</div><p><svg>inline</svg></p>"));
+
+    FragmentCache::instance()->clear();
+}
+
+void HtmlTemplateTest::highlightsCodeBlocksNotInCache()
+{
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<pre><code class=\"cpp\">int i;</code></pre>", HtmlTemplate::CodeHighlighting);
+
+    QVERIFY(html.contains("<pre><code class=\"cpp\">int i;</code></pre>"));
+    QVERIFY(html.contains(HIGHLIGHT_CSS));
+    QVERIFY(html.contains("highlight.pack.js"));
+}
+
+void HtmlTemplateTest::replacesHighlightedCodeByCachedFragments()
+{
+    FragmentCache::instance()->insert("code-", "cpp\nif (a < b)", "<span class=\"hljs-keyword\">if</span> (a &lt; b)");
+
+    HtmlTemplate htmlTemplate(HTML_TEMPLATE);
+
+    QString html = htmlTemplate.render("<pre><code class=\"cpp\">if (a &lt; b)</code></pre>", HtmlTemplate::CodeHighlighting);
+
+    QVERIFY(html.contains("<pre><code class=\"cpp hljs\"><span class=\"hljs-keyword\">if</span> (a &lt; b)</code></pre>"));
+    QVERIFY(html.contains(HIGHLIGHT_CSS));
+    QVERIFY(!html.contains("highlight.pack.js"));
+
+    FragmentCache::instance()->clear();
 }
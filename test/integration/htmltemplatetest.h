@@ -27,6 +27,14 @@ private slots:
 	void rendersContentInsideBodyTags();
     void rendersMermaidGraphInsideCodeTags();
     void replacesMermaidCodeTagsByDivTagsIfCodeHighlightingEnabled();
+    void replacesRenderedDiagramsByCachedFragments();
+    void exportsCachedDiagrams();
+    void replacesTypesetFormulasByCachedFragments();
+    void loadsMathJaxOnlyForFormulasNotTypesetYet();
+    void ignoresFormulasInsideCodeTags();
+    void ignoresFormulasInsideDiagrams();
+    void highlightsCodeBlocksNotInCache();
+    void replacesHighlightedCodeByCachedFragments();
 };
 
 #endif // HTMLTEMPLATETEST_H
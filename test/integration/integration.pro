@@ -12,22 +12,26 @@ CONFIG += console testcase
 CONFIG += c++11
 
 SOURCES += \
+    chunkedmarkdownconvertertest.cpp \
     discountmarkdownconvertertest.cpp \
     htmlpreviewcontrollertest.cpp \
     htmltemplatetest.cpp \
     jsonsnippetfiletest.cpp \
     jsonthemefiletest.cpp \
     main.cpp \
+    pmhchunkedparsertest.cpp \
     pmhmarkdownparsertest.cpp \
     revealmarkdownconvertertest.cpp \
     themecollectiontest.cpp
 
 HEADERS += \
+    chunkedmarkdownconvertertest.h \
     discountmarkdownconvertertest.h \
     htmlpreviewcontrollertest.h \
     htmltemplatetest.h \
     jsonsnippetfiletest.h \
     jsonthemefiletest.h \
+    pmhchunkedparsertest.h \
     pmhmarkdownparsertest.h \
     revealmarkdownconvertertest.h \
     themecollectiontest.h
@@ -18,11 +18,13 @@
 
 #include <QApplication>
 
+#include "chunkedmarkdownconvertertest.h"
 #include "discountmarkdownconvertertest.h"
 #include "htmlpreviewcontrollertest.h"
 #include "htmltemplatetest.h"
 #include "jsonsnippetfiletest.h"
 #include "jsonthemefiletest.h"
+#include "pmhchunkedparsertest.h"
 #include "pmhmarkdownparsertest.h"
 #include "revealmarkdownconvertertest.h"
 #include "themecollectiontest.h"
@@ -66,6 +68,12 @@ int main(int argc, char *argv[])
     ThemeCollectionTest test9;
     ret += QTest::qExec(&test9, argc, argv);
 
+    PmhChunkedParserTest test10;
+    ret += QTest::qExec(&test10, argc, argv);
+
+    ChunkedMarkdownConverterTest test11;
+    ret += QTest::qExec(&test11, argc, argv);
+
     return ret;
 }
 
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "pmhchunkedparsertest.h"
+
+#include <QtTest>
+
+#include <pmhchunkedparser.h>
+
+static int alwaysCancel(void *)
+{
+    return 1;
+}
+
+static QStringList elementList(pmh_element **elements)
+{
+    QStringList list;
+    for (int i = 0; i < pmh_NUM_LANG_TYPES; i++) {
+        for (pmh_element *element = elements[i]; element != NULL; element = element->next) {
+            list << QString("%1:%2-%3").arg(i).arg(element->pos).arg(element->end);
+        }
+    }
+    list.sort();
+    return list;
+}
+
+static QString sectionText(int number)
+{
+    return QString("# Header %1\n"
+                   "\n"
+                   "Paragraph with *emphasis*, **strong**, `code` and a [reference link][ref%1].\n"
+                   "Some text \xF0\x9F\x98\x80 outside of the basic plane.\n"
+                   "\n"
+                   "- first item\n"
+                   "- second item\n"
+                   "\n"
+                   "  continued item\n"
+                   "\n"
+                   "    indented code\n"
+                   "\n"
+                   "> a quote\n"
+                   "with lazy continuation\n"
+                   "\n"
+                   "<div>\n"
+                   "\n"
+                   "HTML block\n"
+                   "\n"
+                   "</div>\n"
+                   "\n"
+                   "Header %1\n"
+                   "---------\n"
+                   "\n").arg(number);
+}
+
+static QString documentText()
+{
+    QString text;
+    for (int i = 0; i < 20; ++i) {
+        text += sectionText(i);
+    }
+    for (int i = 0; i < 20; ++i) {
+        text += QString("[ref%1]: http://example.com/%1\n").arg(i);
+    }
+    return text;
+}
+
+void PmhChunkedParserTest::splitsOnlyInFrontOfTopLevelParagraphs()
+{
+    const QString text = "Paragraph one\n"
+                         "\n"
+                         "- item\n"
+                         "\n"
+                         "    code\n"
+                         "\n"
+                         "> quote\n"
+                         "\n"
+                         "Paragraph two\n";
+
+    QVector<PmhChunkedParser::Chunk> chunks = PmhChunkedParser::splitIntoChunks(text, 1);
+
+    QCOMPARE(chunks.size(), 2);
+    QCOMPARE(chunks[0].position, 0);
+    QCOMPARE(chunks[1].position, text.indexOf("Paragraph two"));
+    QCOMPARE(chunks[1].length, text.length() - chunks[1].position);
+}
+
+void PmhChunkedParserTest::doesNotSplitInsideCodeFencesAndHtmlBlocks()
+{
+    const QString text = "```\n"
+                         "\n"
+                         "code\n"
+                         "```\n"
+                         "\n"
+                         "<div>\n"
+                         "\n"
+                         "html\n"
+                         "</div>\n"
+                         "\n"
+                         "<!--\n"
+                         "\n"
+                         "comment -->\n"
+                         "\n"
+                         "Paragraph\n";
+
+    QVector<PmhChunkedParser::Chunk> chunks = PmhChunkedParser::splitIntoChunks(text, 1);
+
+    QCOMPARE(chunks.size(), 2);
+    QCOMPARE(chunks[1].position, text.indexOf("Paragraph"));
+}
+
+void PmhChunkedParserTest::doesNotSplitInsideNestedHtmlBlocks()
+{
+    const QString text = "<div>\n"
+                         "<div>\n"
+                         "\n"
+                         "inner\n"
+                         "</div>\n"
+                         "<br>\n"
+                         "\n"
+                         "outer\n"
+                         "</div>\n"
+                         "\n"
+                         "Paragraph\n";
+
+    QVector<PmhChunkedParser::Chunk> chunks = PmhChunkedParser::splitIntoChunks(text, 1);
+
+    QCOMPARE(chunks.size(), 2);
+    QCOMPARE(chunks[1].position, text.indexOf("Paragraph"));
+}
+
+void PmhChunkedParserTest::doesNotSplitSmallDocuments()
+{
+    const QString text = documentText();
+
+    QVector<PmhChunkedParser::Chunk> chunks = PmhChunkedParser::splitIntoChunks(text, text.length());
+
+    QCOMPARE(chunks.size(), 1);
+    QCOMPARE(chunks[0].length, text.length());
+}
+
+void PmhChunkedParserTest::returnsSameElementsAsSerialParse()
+{
+    const QString text = documentText();
+    QVERIFY(PmhChunkedParser::splitIntoChunks(text, 256).size() > 4);
+
+    QByteArray utf8 = text.toUtf8();
+    pmh_element **serialElements;
+    pmh_markdown_to_elements(utf8.data(), pmh_EXT_NONE, &serialElements);
+    pmh_element **chunkedElements = PmhChunkedParser::parse(text, pmh_EXT_NONE, 0, 0, 256);
+
+    QVERIFY(chunkedElements != 0);
+    QCOMPARE(elementList(chunkedElements), elementList(serialElements));
+
+    pmh_free_elements(serialElements);
+    pmh_free_elements(chunkedElements);
+}
+
+void PmhChunkedParserTest::resolvesReferencesDefinedInOtherChunks()
+{
+    const QString text = documentText();
+
+    pmh_element **elements = PmhChunkedParser::parse(text, pmh_EXT_NONE, 0, 0, 256);
+
+    int links = 0;
+    for (pmh_element *element = elements[pmh_LINK]; element != NULL; element = element->next) {
+        QVERIFY(element->address != NULL);
+        links++;
+    }
+    QCOMPARE(links, 20);
+
+    pmh_free_elements(elements);
+}
+
+void PmhChunkedParserTest::resolvesDuplicateReferencesLikeSerialParse()
+{
+    const QString text = "A [duplicate link][dup].\n\n"
+                         "[dup]: http://example.com/first\n\n" +
+                         documentText() +
+                         "\n[dup]: http://example.com/second\n";
+    QVERIFY(PmhChunkedParser::splitIntoChunks(text, 256).size() > 4);
+
+    QByteArray utf8 = text.toUtf8();
+    pmh_element **serialElements;
+    pmh_markdown_to_elements(utf8.data(), pmh_EXT_NONE, &serialElements);
+    pmh_element **chunkedElements = PmhChunkedParser::parse(text, pmh_EXT_NONE, 0, 0, 256);
+
+    QStringList serialAddresses;
+    for (pmh_element *element = serialElements[pmh_LINK]; element != NULL; element = element->next) {
+        serialAddresses << QString("%1:%2").arg(element->pos).arg(element->address);
+    }
+    QStringList chunkedAddresses;
+    for (pmh_element *element = chunkedElements[pmh_LINK]; element != NULL; element = element->next) {
+        chunkedAddresses << QString("%1:%2").arg(element->pos).arg(element->address);
+    }
+    serialAddresses.sort();
+    chunkedAddresses.sort();
+
+    QCOMPARE(chunkedAddresses, serialAddresses);
+
+    pmh_free_elements(serialElements);
+    pmh_free_elements(chunkedElements);
+}
+
+void PmhChunkedParserTest::cancelledParseReturnsNoElements()
+{
+    // the parser polls for cancellation every few thousand characters
+    const QString text = documentText().repeated(10);
+
+    pmh_element **elements = PmhChunkedParser::parse(text, pmh_EXT_NONE, alwaysCancel, 0, 16 * 1024);
+
+    QVERIFY(elements == 0);
+}
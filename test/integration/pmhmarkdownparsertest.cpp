@@ -19,8 +19,19 @@
 #include <QtTest>
 
 #include <pmhmarkdownparser.h>
+#include <pmh_parser.h>
 #include "loremipsumtestdata.h"
 
+static int alwaysCancel(void *)
+{
+    return 1;
+}
+
+static int neverCancel(void *)
+{
+    return 0;
+}
+
 void PmhMarkdownParserTest::initTestCase()
 {
     parser = new PmhMarkdownParser();
@@ -83,6 +94,33 @@ void PmhMarkdownParserTest::entryHasStartAndEndPosition()
     QCOMPARE(element.end, (unsigned long)11); 
 }
 
+void PmhMarkdownParserTest::cancelledParseReturnsNoElements()
+{
+    QByteArray text = (fiveHundredWordsLoremIpsumText + fiveHundredWordsLoremIpsumText).toUtf8();
+    pmh_element **elements = 0;
+
+    bool finished = pmh_markdown_to_elements_cancellable(text.data(), pmh_EXT_NONE, &elements,
+                                                         alwaysCancel, 0);
+
+    QVERIFY(!finished);
+    QVERIFY(elements == 0);
+}
+
+void PmhMarkdownParserTest::parseRunsToCompletionIfNotCancelled()
+{
+    QByteArray text = (fiveHundredWordsLoremIpsumText + fiveHundredWordsLoremIpsumText).toUtf8();
+    pmh_element **elements = 0;
+
+    bool finished = pmh_markdown_to_elements_cancellable(text.data(), pmh_EXT_NONE, &elements,
+                                                         neverCancel, 0);
+
+    QVERIFY(finished);
+    QVERIFY(elements != 0);
+    QVERIFY(elements[pmh_H1] != 0);
+
+    pmh_free_elements(elements);
+}
+
 void PmhMarkdownParserTest::benchmark_data()
 {
     QTest::addColumn<QString>("text");
@@ -35,6 +35,8 @@ private slots:
     void returnsListOfEntriesForSingleMarkdownElementType();
     void entryKnowsItsMarkdownElementType();
     void entryHasStartAndEndPosition();
+    void cancelledParseReturnsNoElements();
+    void parseRunsToCompletionIfNotCancelled();
 
     void benchmark_data();
     void benchmark();
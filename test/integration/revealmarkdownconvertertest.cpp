@@ -33,16 +33,24 @@ void RevealMarkdownConverterTest::convertsEmptyStringToEmptyHtml()
     QVERIFY(html.isNull());
 }
 
-void RevealMarkdownConverterTest::returnsAnyMarkdownTextUnchanged()
+void RevealMarkdownConverterTest::rendersSlidesAsSections()
 {
     MarkdownDocument *doc = converter->createDocument(QStringLiteral("This is an example"), 0);
-    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("This is an example"));
+    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("<section>\n<p>This is an example</p>\n</section>\n"));
 
-    doc = converter->createDocument(QStringLiteral("# This is an example"), 0);
-    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("# This is an example"));
+    doc = converter->createDocument(QStringLiteral("first\n\n---\n\nsecond"), 0);
+    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("<section>\n<p>first</p>\n</section>\n"
+                                                          "<section>\n<p>second</p>\n</section>\n"));
+}
 
-    doc = converter->createDocument(QStringLiteral("## This is an example"), 0);
-    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("## This is an example"));
+void RevealMarkdownConverterTest::nestsVerticalSlides()
+{
+    MarkdownDocument *doc = converter->createDocument(QStringLiteral("first\n\n--\n\nsecond\n\n---\n\nthird"), 0);
+    QCOMPARE(converter->renderAsHtml(doc), QStringLiteral("<section>\n"
+                                                          "<section>\n<p>first</p>\n</section>\n"
+                                                          "<section>\n<p>second</p>\n</section>\n"
+                                                          "</section>\n"
+                                                          "<section>\n<p>third</p>\n</section>\n"));
 }
 
 void RevealMarkdownConverterTest::preservesGermanUmlautsInHtml()
@@ -53,7 +61,7 @@ void RevealMarkdownConverterTest::preservesGermanUmlautsInHtml()
     QString html = converter->renderAsHtml(doc);
 
     QVERIFY(!html.isEmpty());
-    QCOMPARE(html, QStringLiteral("äöüß"));
+    QCOMPARE(html, QStringLiteral("<section>\n<p>äöüß</p>\n</section>\n"));
 }
 
 void RevealMarkdownConverterTest::cleanupTestCase()
@@ -30,7 +30,8 @@ private slots:
     void initTestCase();
 
     void convertsEmptyStringToEmptyHtml();
-    void returnsAnyMarkdownTextUnchanged();
+    void rendersSlidesAsSections();
+    void nestsVerticalSlides();
     void preservesGermanUmlautsInHtml();
 
     void cleanupTestCase();
@@ -2,4 +2,6 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     unit \
-    integration
+    integration \
+    benchmark \
+    typing
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "typingbenchmark.h"
+
+#include <QtTest>
+#include <QApplication>
+#include <QClipboard>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <spellchecker/dictionary.h>
+#include <markdowneditor.h>
+#include <statusbarwidget.h>
+#include "hunspell/spellchecker.h"
+#include "../benchmark/corpusgenerator.h"
+#include "typingsessions.h"
+
+// time between two keystrokes of a fast typist
+static const int KEYSTROKE_INTERVAL = 60;
+
+// maximum time to wait for the editor to paint a keystroke
+static const int PAINT_TIMEOUT = 1000;
+
+// Quits the event loop when the observed widget is painted.
+class PaintObserver : public QObject
+{
+public:
+    explicit PaintObserver(QEventLoop *loop) : loop(loop), painted(false) {}
+
+    bool eventFilter(QObject *watched, QEvent *event)
+    {
+        if (event->type() == QEvent::Paint && !painted) {
+            painted = true;
+            loop->quit();
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+    bool hasPainted() const { return painted; }
+
+private:
+    QEventLoop *loop;
+    bool painted;
+};
+
+static qint64 threadCpuTime()
+{
+    // CPU time of the GUI thread in microseconds
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+    const qint64 kernel = (qint64(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    const qint64 user = (qint64(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return (kernel + user) / 10;
+#else
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return qint64(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+#endif
+}
+
+static double percentile(QVector<double> values, int p)
+{
+    if (values.isEmpty()) {
+        return 0.0;
+    }
+
+    std::sort(values.begin(), values.end());
+    const int rank = (p * values.count() + 99) / 100;
+    return values.at(qMax(rank, 1) - 1);
+}
+
+static QString unescape(const QString &text)
+{
+    QString result = text;
+    return result.replace(QLatin1String("\\n"), QLatin1String("\n"));
+}
+
+
+void TypingBenchmark::typing_data()
+{
+    QTest::addColumn<QString>("session");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("prose, 100 KB document") << PROSE_SESSION << 100 * 1024;
+    QTest::newRow("prose, 1 MB document") << PROSE_SESSION << 1024 * 1024;
+    QTest::newRow("middle, 100 KB document") << MIDDLE_SESSION << 100 * 1024;
+    QTest::newRow("middle, 1 MB document") << MIDDLE_SESSION << 1024 * 1024;
+}
+
+void TypingBenchmark::typing()
+{
+    QFETCH(QString, session);
+    QFETCH(int, size);
+
+    QWidget window;
+    QVBoxLayout *layout = new QVBoxLayout(&window);
+    MarkdownEditor *editor = new MarkdownEditor(&window);
+    StatusBarWidget *statusBar = new StatusBarWidget(editor);
+    layout->addWidget(editor);
+    layout->addWidget(statusBar);
+    window.resize(1024, 768);
+
+    editor->loadStyleFromStylesheet(":/theme/default.txt");
+
+    // use an installed dictionary if there is one
+    QMap<QString, Dictionary> dictionaries = hunspell::SpellChecker::availableDictionaries();
+    if (!dictionaries.isEmpty()) {
+        editor->setSpellingDictionary(dictionaries.contains("en_US") ? dictionaries.value("en_US") : dictionaries.first());
+    }
+    editor->setSpellingCheckEnabled(true);
+
+    editor->setPlainText(CorpusGenerator().generate(size));
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    editor->setFocus();
+
+    // wait until the initial highlighting is applied
+    idle(1500);
+
+    latencies.clear();
+    stalls.clear();
+    unpaintedKeystrokes = 0;
+
+    const qint64 cpuTime = threadCpuTime();
+    replay(editor, session);
+    const double cpuMilliseconds = (threadCpuTime() - cpuTime) / 1000.0;
+
+    const double longestStall = stalls.isEmpty() ? 0.0 : *std::max_element(stalls.begin(), stalls.end());
+    qDebug("%d keystrokes: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms",
+           latencies.count(), percentile(latencies, 50), percentile(latencies, 95),
+           percentile(latencies, 99), percentile(latencies, 100));
+    qDebug("%d stalls between keystrokes, longest %.2f ms", stalls.count(), longestStall);
+    if (unpaintedKeystrokes > 0) {
+        qDebug("%d keystrokes not painted within %d ms", unpaintedKeystrokes, PAINT_TIMEOUT);
+    }
+    qDebug("GUI thread CPU time: %.1f ms (%.2f ms per keystroke)",
+           cpuMilliseconds, cpuMilliseconds / qMax(latencies.count(), 1));
+
+    QTest::setBenchmarkResult(percentile(latencies, 95), QTest::WalltimeMilliseconds);
+}
+
+void TypingBenchmark::replay(MarkdownEditor *editor, const QString &session)
+{
+    foreach (const QString &line, session.split(QLatin1Char('\n'), QString::SkipEmptyParts)) {
+        const int separator = line.indexOf(QLatin1Char(' '));
+        const QString action = line.left(separator);
+        const QString argument = separator < 0 ? QString() : line.mid(separator + 1);
+
+        if (action == "move") {
+            if (argument == "start") {
+                editor->moveCursor(QTextCursor::Start);
+            } else if (argument == "middle") {
+                editor->gotoLine(editor->blockCount() / 2);
+            } else {
+                editor->moveCursor(QTextCursor::End);
+            }
+            idle(KEYSTROKE_INTERVAL);
+        } else if (action == "type") {
+            foreach (const QChar &c, unescape(argument)) {
+                if (c == QLatin1Char('\n')) {
+                    keystroke(editor, Qt::Key_Return, QStringLiteral("\r"));
+                } else if (c == QLatin1Char(' ')) {
+                    keystroke(editor, Qt::Key_Space, c);
+                } else {
+                    keystroke(editor, c.toUpper().unicode() < 0x80 ? c.toUpper().unicode() : Qt::Key_unknown, c);
+                }
+            }
+        } else if (action == "backspace" || action == "delete") {
+            const int key = action == "backspace" ? Qt::Key_Backspace : Qt::Key_Delete;
+            for (int i = 0; i < argument.toInt(); ++i) {
+                keystroke(editor, key, QString());
+            }
+        } else if (action == "paste") {
+            QApplication::clipboard()->setText(unescape(argument));
+            keystroke(editor, Qt::Key_V, QString(), Qt::ControlModifier);
+        } else if (action == "pause") {
+            idle(argument.toInt());
+        } else {
+            QFAIL(qPrintable("unknown action in typing session: " + action));
+        }
+    }
+}
+
+void TypingBenchmark::keystroke(MarkdownEditor *editor, int key, const QString &text, Qt::KeyboardModifiers modifiers)
+{
+    QEventLoop loop;
+    PaintObserver observer(&loop);
+    editor->viewport()->installEventFilter(&observer);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QKeyEvent press(QEvent::KeyPress, key, modifiers, text);
+    QApplication::sendEvent(editor, &press);
+    QKeyEvent release(QEvent::KeyRelease, key, modifiers, text);
+    QApplication::sendEvent(editor, &release);
+
+    // the update request that paints the change is posted with a low
+    // priority, so wait for the paint event of the editor's viewport
+    // itself (the event filter sees it before it is handled)
+    if (!observer.hasPainted()) {
+        QTimer::singleShot(PAINT_TIMEOUT, &loop, SLOT(quit()));
+        loop.exec();
+    }
+
+    editor->viewport()->removeEventFilter(&observer);
+
+    if (observer.hasPainted()) {
+        latencies.append(timer.nsecsElapsed() / 1000000.0);
+    } else {
+        unpaintedKeystrokes++;
+    }
+
+    idle(KEYSTROKE_INTERVAL);
+}
+
+void TypingBenchmark::idle(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the results of the background workers arrive while the user
+    // waits for the next keystroke, measure how long they block
+    while (timer.elapsed() < msecs) {
+        QElapsedTimer busy;
+        busy.start();
+        QCoreApplication::processEvents();
+
+        const double elapsed = busy.nsecsElapsed() / 1000000.0;
+        if (elapsed >= 1.0) {
+            stalls.append(elapsed);
+        }
+
+        QThread::msleep(1);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TYPINGBENCHMARK_H
+#define TYPINGBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+
+class MarkdownEditor;
+
+
+// Replays typing sessions in a MarkdownEditor with highlighter,
+// spell checker and status bar and measures the time from each
+// keystroke until the editor painted the change.
+class TypingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void typing_data();
+    void typing();
+
+private:
+    void replay(MarkdownEditor *editor, const QString &session);
+    void keystroke(MarkdownEditor *editor, int key, const QString &text, Qt::KeyboardModifiers modifiers = Qt::NoModifier);
+    void idle(int msecs);
+
+    QVector<double> latencies;
+    QVector<double> stalls;
+    int unpaintedKeystrokes;
+};
+
+#endif // TYPINGBENCHMARK_H
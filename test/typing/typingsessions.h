@@ -0,0 +1,59 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TYPINGSESSIONS_H
+#define TYPINGSESSIONS_H
+
+#include <QString>
+
+// Recorded typing sessions, one action per line:
+//   move start|middle|end   move the cursor
+//   type <text>             type the text key by key (\n is Return)
+//   backspace <count>       press backspace <count> times
+//   delete <count>          press delete <count> times
+//   paste <text>            paste the text with Ctrl+V (\n is a line break)
+//   pause <ms>              the user stops typing for a while
+
+// writing a new paragraph at the end of the document with some corrections
+static const QString PROSE_SESSION = QStringLiteral(
+    "move end\n"
+    "type \\n\\n## Notes\\n\\nThe preview follows the edtor\n"
+    "backspace 5\n"
+    "type ditor while typing. Long documents shoud\n"
+    "backspace 4\n"
+    "type hould still feel fast, even with **spell checking** enabled.\n"
+    "pause 300\n"
+    "type  See the [reference][notes-1] for details.\n"
+    "paste \\n\\n[notes-1]: https://example.com/notes \"Notes\"\\n\n"
+    "type \\n- first item\\n- second item with `code`\\n  - nested item\\n\n"
+    "pause 700\n"
+    "type Done.\n");
+
+// editing in the middle of the document, where every change
+// shifts the highlighting of the rest of the document
+static const QString MIDDLE_SESSION = QStringLiteral(
+    "move middle\n"
+    "type \\n### Inserted section\\n\\n\n"
+    "paste | Name | Value |\\n|:---|---:|\\n| alpha | 1 |\\n| beta | 2 |\\n\\n\n"
+    "type Some *emphasized* text with $x^2$ math and a footnote[^x].\n"
+    "backspace 20\n"
+    "type footnote.\\n\\n\n"
+    "pause 500\n"
+    "type ```cpp\\nint main() { return 0; }\\n```\\n\n"
+    "delete 10\n"
+    "type > quoted line\\n\\n\n");
+
+#endif // TYPINGSESSIONS_H
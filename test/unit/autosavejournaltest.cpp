@@ -0,0 +1,166 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "autosavejournaltest.h"
+
+#include <QTest>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include "autosavejournal.h"
+
+#ifdef Q_OS_UNIX
+#include <utime.h>
+#endif
+
+void AutosaveJournalTest::init()
+{
+    tempDir.reset(new QTemporaryDir());
+}
+
+void AutosaveJournalTest::recoversSnapshot()
+{
+    {
+        AutosaveJournal journal(journalFileName());
+        QVERIFY(journal.start("# Header\n\nParagraph"));
+        QVERIFY(journal.flush());
+    }
+
+    QString text;
+    QVERIFY(AutosaveJournal::recover(journalFileName(), &text));
+    QCOMPARE(text, QStringLiteral("# Header\n\nParagraph"));
+}
+
+void AutosaveJournalTest::recoversRecordedChanges()
+{
+    QTextDocument document;
+    document.setPlainText("first line\nsecond line");
+
+    AutosaveJournal journal(journalFileName());
+    QVERIFY(journal.start(document.toPlainText()));
+
+    // record changes exactly like the main window
+    connect(&document, &QTextDocument::contentsChange,
+            [&](int position, int charsRemoved, int charsAdded) {
+        QTextCursor cursor(&document);
+        cursor.setPosition(position);
+        cursor.setPosition(qMin(position + charsAdded, document.characterCount() - 1), QTextCursor::KeepAnchor);
+        journal.recordChange(position, charsRemoved, cursor.selectedText().replace(QChar::ParagraphSeparator, '\n'));
+    });
+
+    QTextCursor cursor(&document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("\nthird line");
+    cursor.setPosition(0);
+    cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+    cursor.insertText("1st");
+    cursor.movePosition(QTextCursor::NextBlock);
+    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QVERIFY(journal.flush());
+
+    QString text;
+    QVERIFY(AutosaveJournal::recover(journalFileName(), &text));
+    QCOMPARE(text, document.toPlainText());
+    QCOMPARE(text, QStringLiteral("1st line\nthird line"));
+}
+
+void AutosaveJournalTest::recoversAfterCompaction()
+{
+    AutosaveJournal journal(journalFileName());
+    QVERIFY(journal.start("abc"));
+    journal.recordChange(3, 0, "def");
+    QVERIFY(journal.flush());
+
+    journal.compact("abcdef");
+    journal.recordChange(0, 3, "");
+    QVERIFY(journal.flush());
+
+    QString text;
+    QVERIFY(AutosaveJournal::recover(journalFileName(), &text));
+    QCOMPARE(text, QStringLiteral("def"));
+}
+
+void AutosaveJournalTest::ignoresIncompleteChanges()
+{
+    {
+        AutosaveJournal journal(journalFileName());
+        QVERIFY(journal.start("abc"));
+        journal.recordChange(3, 0, "def");
+        journal.recordChange(6, 0, "ghi");
+        QVERIFY(journal.flush());
+    }
+
+    // simulate a crash while writing the last change
+    QFile file(journalFileName());
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 2));
+    file.close();
+
+    QString text;
+    QVERIFY(AutosaveJournal::recover(journalFileName(), &text));
+    QCOMPARE(text, QStringLiteral("abcdef"));
+}
+
+void AutosaveJournalTest::writesNothingUntilFlushed()
+{
+    AutosaveJournal journal(journalFileName());
+    QVERIFY(journal.start("abc"));
+    journal.recordChange(3, 0, "def");
+
+    QVERIFY(!QFile::exists(journalFileName()));
+    QVERIFY(!AutosaveJournal::isOrphaned(journalFileName()));
+}
+
+void AutosaveJournalTest::removesDiscardedJournal()
+{
+    AutosaveJournal journal(journalFileName());
+    QVERIFY(journal.start("abc"));
+    QVERIFY(journal.flush());
+    QVERIFY(QFile::exists(journalFileName()));
+
+    journal.discard();
+
+    QVERIFY(!QFile::exists(journalFileName()));
+}
+
+void AutosaveJournalTest::keepsLockOfLongRunningSession()
+{
+#ifdef Q_OS_UNIX
+    AutosaveJournal journal(journalFileName());
+    QVERIFY(journal.start("abc"));
+    QVERIFY(journal.flush());
+
+    // age the lock beyond the default stale interval of QLockFile
+    const QByteArray lockFileName = QFile::encodeName(journalFileName() + ".lock");
+    struct utimbuf times;
+    times.actime = times.modtime = time(0) - 3600;
+    QCOMPARE(utime(lockFileName.constData(), &times), 0);
+
+    QVERIFY(!AutosaveJournal::isOrphaned(journalFileName()));
+
+    AutosaveJournal otherJournal(journalFileName());
+    QVERIFY(!otherJournal.start("def"));
+    QVERIFY(QFile::exists(journalFileName()));
+#else
+    QSKIP("needs to change the modification time of the lock file");
+#endif
+}
+
+QString AutosaveJournalTest::journalFileName() const
+{
+    return tempDir->path() + "/test.journal";
+}
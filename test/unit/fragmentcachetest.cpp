@@ -0,0 +1,101 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "fragmentcachetest.h"
+
+#include <QtTest>
+
+#include <fragmentcache.h>
+
+
+void FragmentCacheTest::returnsEmptyStringForUnknownFragments()
+{
+    FragmentCache cache(100);
+
+    QCOMPARE(cache.find("math-inline", "x^2"), QString());
+}
+
+void FragmentCacheTest::findsInsertedFragmentsByKindAndSource()
+{
+    FragmentCache cache(100);
+
+    cache.insert("math-inline", "x^2", "<svg>inline</svg>");
+    cache.insert("math-display", "x^2", "<svg>display</svg>");
+
+    QCOMPARE(cache.find("math-inline", "x^2"), QStringLiteral("<svg>inline</svg>"));
+    QCOMPARE(cache.find("math-display", "x^2"), QStringLiteral("<svg>display</svg>"));
+    QCOMPARE(cache.find("math-inline", "x^3"), QString());
+
+    cache.clear();
+
+    QCOMPARE(cache.find("math-inline", "x^2"), QString());
+}
+
+void FragmentCacheTest::evictsFragmentsIfMaximumSizeExceeded()
+{
+    FragmentCache cache(10);
+
+    cache.insert("math-inline", "a", "12345");
+    cache.insert("math-inline", "b", "12345");
+    cache.insert("math-inline", "c", "12345");
+
+    QCOMPARE(cache.find("math-inline", "a"), QString());
+    QCOMPARE(cache.find("math-inline", "c"), QStringLiteral("12345"));
+
+    // fragments larger than the cache are not stored at all
+    cache.insert("math-inline", "d", "12345678901");
+
+    QCOMPARE(cache.find("math-inline", "d"), QString());
+}
+
+void FragmentCacheTest::keepsFragmentsOfDocumentsApart()
+{
+    FragmentCache cache(100);
+    const quint64 firstDocument = FragmentCache::createScopeId();
+    const quint64 secondDocument = FragmentCache::createScopeId();
+
+    {
+        FragmentCache::Scope scope(firstDocument);
+        cache.insert("math-inline", "x^2", "<svg>first</svg>");
+    }
+
+    {
+        FragmentCache::Scope scope(secondDocument);
+        QCOMPARE(cache.find("math-inline", "x^2"), QString());
+    }
+
+    {
+        FragmentCache::Scope scope(firstDocument);
+        QCOMPARE(cache.find("math-inline", "x^2"), QStringLiteral("<svg>first</svg>"));
+    }
+
+    QCOMPARE(cache.find("math-inline", "x^2"), QString());
+}
+
+void FragmentCacheTest::rejectsFragmentsThatRunScripts()
+{
+    FragmentCache cache(1000);
+
+    cache.insert("code-default", "a", "<span class=\"hljs-keyword\">if</span> (one = 1) &lt;script&gt;");
+    cache.insert("code-default", "b", "<script>alert(1)</script>");
+    cache.insert("code-default", "c", "<img src=\"x\" onerror=\"alert(1)\">");
+    cache.insert("code-default", "d", "<a href=\"javascript:alert(1)\">x</a>");
+
+    QVERIFY(!cache.find("code-default", "a").isEmpty());
+    QCOMPARE(cache.find("code-default", "b"), QString());
+    QCOMPARE(cache.find("code-default", "c"), QString());
+    QCOMPARE(cache.find("code-default", "d"), QString());
+}
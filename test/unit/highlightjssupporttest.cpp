@@ -0,0 +1,42 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "highlightjssupporttest.h"
+
+#include <QFile>
+#include <QTest>
+
+#include <template/highlightjssupport.h>
+
+void HighlightJsSupportTest::exportHeaderContainsHighlightingStyle()
+{
+    QFile file(":/scripts/highlight.js/styles/default.css");
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QString style = QString::fromUtf8(file.readAll());
+
+    const QString header = HighlightJsSupport::buildExportHeader("body {}", "var hljs;", "default");
+
+    QVERIFY(header.contains("<style>body {}</style>"));
+    QVERIFY(header.contains("<style>" + style + "</style>"));
+    QVERIFY(header.contains("<script>var hljs;</script>"));
+}
+
+void HighlightJsSupportTest::exportHeaderWithoutScriptHasNoHighlighting()
+{
+    const QString header = HighlightJsSupport::buildExportHeader("body {}", QString(), "default");
+
+    QCOMPARE(header, QStringLiteral("\n<style>body {}</style>"));
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "latencytracertest.h"
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <latencytracer.h>
+
+
+void LatencyTracerTest::measuresLatencySinceEditAndPreviousStage()
+{
+    LatencyTracer tracer;
+
+    tracer.mark(0, 1, LatencyTracer::PreviewRequested, 1000);
+    tracer.mark(0, 1, LatencyTracer::PreviewStarted, 1500);
+    tracer.mark(0, 1, LatencyTracer::PreviewRendered, 1800);
+
+    // a stage is only counted once per revision
+    tracer.mark(0, 1, LatencyTracer::PreviewRendered, 5000);
+
+    LatencyTracer::Statistics rendered = tracer.stageStatistics(LatencyTracer::PreviewRendered);
+    QCOMPARE(rendered.count, 1);
+    QCOMPARE(rendered.p50, qint64(300));
+
+    LatencyTracer::Statistics total = tracer.totalStatistics(LatencyTracer::PreviewRendered);
+    QCOMPARE(total.p50, qint64(800));
+}
+
+void LatencyTracerTest::ignoresStagesOfUntracedRevisions()
+{
+    LatencyTracer tracer;
+
+    tracer.mark(0, 1, LatencyTracer::HighlightRequested, 1000);
+    tracer.mark(0, 2, LatencyTracer::HighlightApplied, 2000);
+
+    QCOMPARE(tracer.stageStatistics(LatencyTracer::HighlightRequested).count, 1);
+    QCOMPARE(tracer.stageStatistics(LatencyTracer::HighlightApplied).count, 0);
+}
+
+void LatencyTracerTest::reportsPercentilesOfLastSamples()
+{
+    LatencyTracer tracer(100);
+
+    // the first samples are replaced by the later ones
+    for (int revision = 1; revision <= 200; ++revision) {
+        tracer.mark(0, revision, LatencyTracer::PreviewRequested, 0);
+        tracer.mark(0, revision, LatencyTracer::PreviewStarted, revision <= 100 ? 1000 : revision - 100);
+    }
+
+    LatencyTracer::Statistics started = tracer.stageStatistics(LatencyTracer::PreviewStarted);
+    QCOMPARE(started.count, 100);
+    QCOMPARE(started.p50, qint64(50));
+    QCOMPARE(started.p95, qint64(95));
+    QCOMPARE(started.p99, qint64(99));
+}
+
+void LatencyTracerTest::exportsStatisticsAsJson()
+{
+    LatencyTracer tracer;
+    tracer.mark(0, 1, LatencyTracer::HighlightRequested, 100);
+    tracer.mark(0, 1, LatencyTracer::HighlightParsed, 400);
+
+    QJsonObject root = QJsonDocument::fromJson(tracer.toJson()).object();
+    QCOMPARE(root.value("unit").toString(), QStringLiteral("us"));
+
+    QJsonArray stages = root.value("stages").toArray();
+    QCOMPARE(stages.count(), int(LatencyTracer::StageCount));
+
+    QJsonObject parsed = stages.at(LatencyTracer::HighlightParsed).toObject();
+    QCOMPARE(parsed.value("name").toString(), QStringLiteral("highlight-parsed"));
+    QCOMPARE(parsed.value("count").toInt(), 1);
+    QCOMPARE(parsed.value("sinceStage").toObject().value("p99").toInt(), 300);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "latestvaluemailboxtest.h"
+
+#include <QtTest>
+#include <QThread>
+
+#include <latestvaluemailbox.h>
+
+class PostingThread : public QThread
+{
+public:
+    explicit PostingThread(LatestValueMailbox<QString> *mailbox) : mailbox(mailbox) {}
+
+protected:
+    void run()
+    {
+        msleep(50);
+        mailbox->post("posted");
+    }
+
+private:
+    LatestValueMailbox<QString> *mailbox;
+};
+
+
+void LatestValueMailboxTest::isEmptyInitially()
+{
+    LatestValueMailbox<QString> mailbox;
+    QVERIFY(mailbox.isEmpty());
+}
+
+void LatestValueMailboxTest::keepsOnlyTheLatestValue()
+{
+    LatestValueMailbox<QString> mailbox;
+    mailbox.post("first");
+    mailbox.post("second");
+    mailbox.post("third");
+
+    QVERIFY(!mailbox.isEmpty());
+    QCOMPARE(mailbox.take(), QStringLiteral("third"));
+    QVERIFY(mailbox.isEmpty());
+}
+
+void LatestValueMailboxTest::takeWaitsForPostFromOtherThread()
+{
+    LatestValueMailbox<QString> mailbox;
+
+    PostingThread thread(&mailbox);
+    thread.start();
+
+    QCOMPARE(mailbox.take(), QStringLiteral("posted"));
+    thread.wait();
+}
@@ -16,17 +16,26 @@
  */
 #include <QTest>
 
+#include "autosavejournaltest.h"
 #include "dictionarytest.h"
+#include "fragmentcachetest.h"
+#include "highlightjssupporttest.h"
 #include "jsonsnippettranslatortest.h"
 #include "jsonthemetranslatortest.h"
+#include "latencytracertest.h"
+#include "latestvaluemailboxtest.h"
 #include "jsontranslatorfactorytest.h"
 #include "slidelinemappingtest.h"
 #include "snippetcollectiontest.h"
+#include "sourcelineannotatortest.h"
+#include "stallwatchdogtest.h"
 #include "completionlistmodeltest.h"
 #include "snippettest.h"
 #include "stylemanagertest.h"
 #include "themecollectiontest.h"
 #include "themetest.h"
+#include "tracerecordertest.h"
+#include "wordcountertest.h"
 #include "yamlheadercheckertest.h"
 
 int main(int argc, char *argv[])
@@ -69,5 +78,32 @@ int main(int argc, char *argv[])
     JsonThemeTranslatorTest test12;
     ret += QTest::qExec(&test12, argc, argv);
 
+    AutosaveJournalTest test13;
+    ret += QTest::qExec(&test13, argc, argv);
+
+    SourceLineAnnotatorTest test14;
+    ret += QTest::qExec(&test14, argc, argv);
+
+    FragmentCacheTest test15;
+    ret += QTest::qExec(&test15, argc, argv);
+
+    LatencyTracerTest test16;
+    ret += QTest::qExec(&test16, argc, argv);
+
+    TraceRecorderTest test17;
+    ret += QTest::qExec(&test17, argc, argv);
+
+    WordCounterTest test18;
+    ret += QTest::qExec(&test18, argc, argv);
+
+    StallWatchdogTest test19;
+    ret += QTest::qExec(&test19, argc, argv);
+
+    LatestValueMailboxTest test20;
+    ret += QTest::qExec(&test20, argc, argv);
+
+    HighlightJsSupportTest test21;
+    ret += QTest::qExec(&test21, argc, argv);
+
     return ret;
 }
@@ -102,3 +102,41 @@ void SlideLineMappingTest::returnsSlideForEachLine()
     QCOMPARE(mapping.slideForLine(7), qMakePair(1, 0));
     QCOMPARE(mapping.slideForLine(8), qMakePair(-1, -1));
 }
+
+void SlideLineMappingTest::updatesChangedLines_data()
+{
+    QTest::addColumn<QString>("before");
+    QTest::addColumn<QString>("after");
+    QTest::addColumn<int>("firstLine");
+    QTest::addColumn<int>("lastLine");
+
+    QString deck = "Slide 1\n\n---\n\nSlide 2\n\n--\n\nSlide 3\n\n---\n\nSlide 4";
+
+    QTest::newRow("edit inside slide") << deck << QString(deck).replace("Slide 2", "Slide 2b") << 4 << 4;
+    QTest::newRow("insert separator") << deck << QString(deck).replace("Slide 3", "Slide 3\n\n---\n\nSlide 3b") << 8 << 12;
+    QTest::newRow("remove separator") << deck << QString(deck).replace("\n\n--\n\n", "\n") << 4 << 5;
+    QTest::newRow("break separator") << deck << QString(deck).replace("\n--\n", "\n--x\n") << 6 << 6;
+    QTest::newRow("insert lines at start") << deck << "Title\n\n\n" + deck << 0 << 3;
+    QTest::newRow("remove lines at start") << deck << deck.mid(9) << 0 << 0;
+    QTest::newRow("append slide") << deck << deck + "\n\n---\n\nSlide 5" << 12 << 16;
+}
+
+void SlideLineMappingTest::updatesChangedLines()
+{
+    QFETCH(QString, before);
+    QFETCH(QString, after);
+    QFETCH(int, firstLine);
+    QFETCH(int, lastLine);
+
+    QStringList lines = after.split('\n');
+
+    SlideLineMapping mapping;
+    mapping.build(before);
+    mapping.update(firstLine, lastLine, lines.count(), [&lines](int index) { return lines.at(index); });
+
+    SlideLineMapping expected;
+    expected.build(after);
+
+    QCOMPARE(mapping.lineToSlide(), expected.lineToSlide());
+    QCOMPARE(mapping.slideToLine(), expected.slideToLine());
+}
@@ -29,6 +29,8 @@ private slots:
     void verticalSlideSeparatorMustBeSurroundedByBlankLines();
     void holdsEntryForeachSlide();
     void returnsSlideForEachLine();
+    void updatesChangedLines_data();
+    void updatesChangedLines();
 };
 
 #endif // SLIDELINEMAPPINGTEST_H
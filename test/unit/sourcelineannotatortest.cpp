@@ -0,0 +1,133 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sourcelineannotatortest.h"
+
+#include <QTest>
+
+#include "sourcelineannotator.h"
+
+void SourceLineAnnotatorTest::annotatesTopLevelBlocks()
+{
+    QString text = "# Header\n"
+                   "\n"
+                   "first paragraph\n"
+                   "continued\n"
+                   "\n"
+                   "second paragraph\n";
+
+    QString expected = "<div data-source-line=\"1\"></div>\n\n"
+                       "# Header\n"
+                       "\n"
+                       "<div data-source-line=\"3\"></div>\n\n"
+                       "first paragraph\n"
+                       "continued\n"
+                       "\n"
+                       "<div data-source-line=\"6\"></div>\n\n"
+                       "second paragraph\n";
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), expected);
+}
+
+void SourceLineAnnotatorTest::ignoresIndentedLines()
+{
+    QString text = "paragraph\n"
+                   "\n"
+                   "    code\n";
+
+    QString expected = "<div data-source-line=\"1\"></div>\n\n"
+                       "paragraph\n"
+                       "\n"
+                       "    code\n";
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), expected);
+}
+
+void SourceLineAnnotatorTest::ignoresListItems()
+{
+    QString text = "1. first\n"
+                   "\n"
+                   "2. second\n"
+                   "\n"
+                   "- item\n"
+                   "\n"
+                   "a. alphabetic item\n";
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), text);
+}
+
+void SourceLineAnnotatorTest::ignoresFencedCode()
+{
+    QString text = "```\n"
+                   "code\n"
+                   "\n"
+                   "more code\n"
+                   "```\n";
+
+    QString expected = "<div data-source-line=\"1\"></div>\n\n" + text;
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), expected);
+}
+
+void SourceLineAnnotatorTest::ignoresNestedHtmlBlocks()
+{
+    QString text = "<div>\n"
+                   "<div>\n"
+                   "\n"
+                   "inner\n"
+                   "</div>\n"
+                   "\n"
+                   "outer\n"
+                   "</div>\n";
+
+    QString expected = "<div data-source-line=\"1\"></div>\n\n" + text;
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), expected);
+}
+
+void SourceLineAnnotatorTest::ignoresContinuedBlockQuotes()
+{
+    QString text = "> first\n"
+                   "\n"
+                   "> same quote\n"
+                   "\n"
+                   "paragraph\n";
+
+    QString expected = "<div data-source-line=\"1\"></div>\n\n"
+                       "> first\n"
+                       "\n"
+                       "> same quote\n"
+                       "\n"
+                       "<div data-source-line=\"5\"></div>\n\n"
+                       "paragraph\n";
+
+    QCOMPARE(SourceLineAnnotator::annotate(text), expected);
+}
+
+void SourceLineAnnotatorTest::countsLinesFromFirstLineNumber()
+{
+    QString text = "paragraph\n"
+                   "\n"
+                   "# Header\n";
+
+    QString expected = "<div data-source-line=\"11\"></div>\n\n"
+                       "paragraph\n"
+                       "\n"
+                       "<div data-source-line=\"13\"></div>\n\n"
+                       "# Header\n";
+
+    QCOMPARE(SourceLineAnnotator::annotate(text, 11), expected);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOURCELINEANNOTATORTEST_H
+#define SOURCELINEANNOTATORTEST_H
+
+#include <QObject>
+
+class SourceLineAnnotatorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void annotatesTopLevelBlocks();
+    void ignoresIndentedLines();
+    void ignoresListItems();
+    void ignoresFencedCode();
+    void ignoresNestedHtmlBlocks();
+    void ignoresContinuedBlockQuotes();
+    void countsLinesFromFirstLineNumber();
+};
+
+#endif // SOURCELINEANNOTATORTEST_H
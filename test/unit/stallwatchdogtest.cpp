@@ -0,0 +1,64 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "stallwatchdogtest.h"
+
+#include <QtTest>
+#include <QThread>
+
+#include <stallwatchdog.h>
+#include <tracerecorder.h>
+
+// the unit tests run without an event loop,
+// so the heartbeats are sent manually
+
+void StallWatchdogTest::attributesStallToInnermostScope()
+{
+    StallWatchdog watchdog;
+    watchdog.setDocumentState(1024, 7);
+    watchdog.startWatching(50);
+
+    {
+        TraceSpan outer("outer", "test");
+        TraceSpan inner("inner", "test");
+        QThread::msleep(200);
+    }
+    watchdog.heartbeat();
+
+    QTRY_COMPARE(watchdog.stalls().count(), 1);
+    watchdog.stopWatching();
+
+    StallWatchdog::Stall stall = watchdog.stalls().first();
+    QCOMPARE(stall.scopes, QStringList() << "outer" << "inner");
+    QVERIFY(stall.duration >= 150);
+    QCOMPARE(stall.documentSize, 1024);
+    QCOMPARE(stall.revision, 7);
+}
+
+void StallWatchdogTest::ignoresPausesBelowThreshold()
+{
+    StallWatchdog watchdog;
+    watchdog.startWatching(200);
+
+    for (int i = 0; i < 30; ++i) {
+        QThread::msleep(10);
+        watchdog.heartbeat();
+    }
+
+    watchdog.stopWatching();
+
+    QVERIFY(watchdog.stalls().isEmpty());
+}
@@ -68,6 +68,19 @@ void ThemeCollectionTest::returnsThemeByName()
     QCOMPARE(actual, theme);
 }
 
+void ThemeCollectionTest::returnsFirstThemeWithSameName()
+{
+    Theme theme1("name", "markdown 1", "code", "preview");
+    Theme theme2("name", "markdown 2", "code", "preview");
+    ThemeCollection collection;
+    collection.insert(theme1);
+    collection.insert(theme2);
+
+    Theme actual = collection.theme("name");
+
+    QCOMPARE(actual, theme1);
+}
+
 void ThemeCollectionTest::returnsNameOfAllThemes()
 {
     Theme theme1("name 1", "markdown", "code", "preview");
@@ -29,6 +29,7 @@ private slots:
     void returnsThemeAtIndexPosition();
     void returnsIfCollectionContainsTheme();
     void returnsThemeByName();
+    void returnsFirstThemeWithSameName();
     void returnsNameOfAllThemes();
 };
 
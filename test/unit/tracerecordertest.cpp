@@ -0,0 +1,122 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tracerecordertest.h"
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <tracerecorder.h>
+
+static QJsonArray completeEvents()
+{
+    QJsonArray events;
+    QJsonObject root = QJsonDocument::fromJson(TraceRecorder::instance()->toJson()).object();
+    foreach (const QJsonValue &value, root.value("traceEvents").toArray()) {
+        if (value.toObject().value("ph").toString() == "X") {
+            events.append(value);
+        }
+    }
+    return events;
+}
+
+class SpanThread : public QThread
+{
+protected:
+    void run()
+    {
+        TraceSpan span("SpanThread::run", "test");
+    }
+};
+
+
+void TraceRecorderTest::cleanup()
+{
+    TraceRecorder::instance()->setEnabled(false);
+    TraceRecorder::instance()->clear();
+}
+
+void TraceRecorderTest::recordsNothingIfDisabled()
+{
+    {
+        TraceSpan span("disabled", "test");
+    }
+
+    QCOMPARE(completeEvents().count(), 0);
+}
+
+void TraceRecorderTest::recordsSpansAsCompleteEvents()
+{
+    TraceRecorder::instance()->setEnabled(true);
+    {
+        TraceSpan span("outer", "test");
+        TraceSpan inner("inner", "test");
+    }
+
+    QJsonArray events = completeEvents();
+    QCOMPARE(events.count(), 2);
+
+    // the inner span ends first
+    QJsonObject inner = events.at(0).toObject();
+    QJsonObject outer = events.at(1).toObject();
+    QCOMPARE(inner.value("name").toString(), QStringLiteral("inner"));
+    QCOMPARE(outer.value("name").toString(), QStringLiteral("outer"));
+    QCOMPARE(outer.value("cat").toString(), QStringLiteral("test"));
+    QVERIFY(outer.value("ts").toDouble() <= inner.value("ts").toDouble());
+    QVERIFY(outer.value("dur").toDouble() >= inner.value("dur").toDouble());
+}
+
+void TraceRecorderTest::recordsSpansOfEachThreadSeparately()
+{
+    TraceRecorder::instance()->setEnabled(true);
+    {
+        TraceSpan span("main", "test");
+    }
+
+    SpanThread thread;
+    thread.start();
+    thread.wait();
+
+    QJsonArray events = completeEvents();
+    QCOMPARE(events.count(), 2);
+    QVERIFY(events.at(0).toObject().value("tid") != events.at(1).toObject().value("tid"));
+}
+
+void TraceRecorderTest::boundsNumberOfThreadBuffers()
+{
+    TraceRecorder::instance()->setEnabled(true);
+
+    for (int i = 0; i < 100; ++i) {
+        SpanThread thread;
+        thread.setObjectName(QString("SpanThread %1").arg(i));
+        thread.start();
+        thread.wait();
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(TraceRecorder::instance()->toJson()).object();
+    int threadNames = 0;
+    foreach (const QJsonValue &value, root.value("traceEvents").toArray()) {
+        if (value.toObject().value("ph").toString() == "M") {
+            threadNames++;
+        }
+    }
+
+    QVERIFY(threadNames <= 32);
+    QVERIFY(completeEvents().count() > 0);
+}
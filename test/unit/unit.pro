@@ -12,32 +12,53 @@ CONFIG += c++11
 
 SOURCES += \
     main.cpp \
+    autosavejournaltest.cpp \
     completionlistmodeltest.cpp \
+    fragmentcachetest.cpp \
+    highlightjssupporttest.cpp \
+    latencytracertest.cpp \
+    latestvaluemailboxtest.cpp \
     snippettest.cpp \
     jsonsnippettranslatortest.cpp \
     jsonthemetranslatortest.cpp \
     jsontranslatorfactorytest.cpp \
     slidelinemappingtest.cpp \
+    sourcelineannotatortest.cpp \
     snippetcollectiontest.cpp \
     dictionarytest.cpp \
     yamlheadercheckertest.cpp \
     themetest.cpp \
     themecollectiontest.cpp \
-    stylemanagertest.cpp
+    stylemanagertest.cpp \
+    stallwatchdogtest.cpp \
+    tracerecordertest.cpp \
+    wordcountertest.cpp
 
 HEADERS += \
+    autosavejournaltest.h \
     completionlistmodeltest.h \
+    fragmentcachetest.h \
+    highlightjssupporttest.h \
+    latencytracertest.h \
+    latestvaluemailboxtest.h \
     snippettest.h \
     jsonsnippettranslatortest.h \
     jsonthemetranslatortest.h \
     jsontranslatorfactorytest.h \
     slidelinemappingtest.h \
+    sourcelineannotatortest.h \
     snippetcollectiontest.h \
     dictionarytest.h \
     yamlheadercheckertest.h \
     themetest.h \
     themecollectiontest.h \
-    stylemanagertest.h
+    stylemanagertest.h \
+    stallwatchdogtest.h \
+    tracerecordertest.h \
+    wordcountertest.h
+
+RESOURCES += \
+    unit.qrc
 
 target.CONFIG += no_default_install
 
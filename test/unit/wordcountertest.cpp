@@ -0,0 +1,41 @@
+/*
+ * Copyright 2016 Christian Loose <christian.loose@hamburg.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wordcountertest.h"
+
+#include <QtTest>
+
+#include <wordcounter.h>
+
+
+void WordCounterTest::returnsZeroForEmptyText()
+{
+    QCOMPARE(WordCounter::countWords(QString()), 0);
+    QCOMPARE(WordCounter::countWords(" \n\t "), 0);
+}
+
+void WordCounterTest::countsWordsSeparatedByWhitespace()
+{
+    QCOMPARE(WordCounter::countWords("word"), 1);
+    QCOMPARE(WordCounter::countWords("  two\twords\n"), 2);
+    QCOMPARE(WordCounter::countWords("# Header\n\n- list *item*"), 5);
+}
+
+void WordCounterTest::extractsDistinctWordsForCompletion()
+{
+    QStringList words = WordCounter::distinctWords("# Markdown\n\nThe editor, the *editor* and a zebra.");
+    QCOMPARE(words, QStringList() << "editor" << "Markdown" << "zebra");
+}